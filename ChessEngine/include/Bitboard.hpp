@@ -6,54 +6,30 @@
 
 class Bitboard {
 private:
-    // Piece bitboards indexed by [color][pieceType]
-    uint64_t piece_bitboards[2][6];
+    // Pieces, keys, scores and rights of the current position, copied as a whole by clones and copy-make
+    Position pos;
 
-    // Lookup table for fast piece type checking
-    PieceType piece_at_square[64];
+    // Zobrist keys of the game and the current search path, indexed by ply_count (ring buffer)
+    // Every applied move writes its key, undoing needs no update since only keys up to ply_count are read
+    // Used for both threefold repetition adjudication and draw detection in search
+    uint64_t key_history[KEY_HISTORY_SIZE];
 
-    // Board state scores updated incrementally
-    int material_score;
-    int positional_score;
-    int game_phase_score;
-
-    // Store castling rights as a bitmask
-    // Bit 0 : White kingside(K)
-    // Bit 1 : White queenside(Q)
-    // Bit 2 : Black kingside(k)
-    // Bit 3 : Black queenside(q)
-    uint8_t castling_rights;
-
-    // The square where a pawn can be captured en passant
-    // If not possible, set UNASSIGNED
-    int en_passant_target;
-
-    int half_moves; // Helps determine if a draw can be claimed
-    int ply_count; // = Half moves since game start (used for mate-distance -calculation)
-
-    PinData pin_data; // Data of pinned pieces
-    AttackData attack_data; // Data of attack squares and attack ray to king
-
-    uint64_t hash_key; // Unique key updated incrementally after each move
-
-    // Zobrist hashing for threefold repetition detection
-    // Updated after applying an actual move (not ai searches)
-    std::unordered_map<uint64_t, int> position_history;
-
-    // Stack to store undo-info for efficient board state restoring
+    // Search stack of the thread searching this board, set by startNewSearch
+    // Holds the undo-info for efficient board state restoring
     // Used by ai in minimax and q-search
-    std::vector<UndoInfo> undo_stack;
+    SearchStack* search_stack;
+    int search_ply; // Moves applied since the search started, index of the next stack entry
 
-    // Stack to hold the position history for the current search path
-    // Used by ai for draw detection in search paths
-    std::vector<uint64_t> search_history;
+    // Copy-make: moves save the whole position to the search stack and undoing copies it back
+    // Otherwise undoing reverses the move from the undo info (unmake)
+    bool copy_make;
 
 public:
     // Initialize each piece with starting pos
     Bitboard();
 
-    // Store the game state as a bitmask
-    BoardState state;
+    // Get the game state bitmask
+    const BoardState& getState() const { return pos.state; }
 
     // Helpers for FEN-string creation
     char getPieceTypeChar(int square) const;
@@ -80,6 +56,10 @@ public:
     // Check if the move resulted in and update state accordingly
     void updateDrawByRepetition();
 
+    // Check if the AI move ended the game in checkmate or stalemate and update state accordingly
+    // applyMoveAI leaves them to the search, takes the side that moved as the parameter
+    void updateGameOver(bool white);
+
     int getPlyCount() const;
 
 private:
@@ -90,21 +70,26 @@ private:
     // Updated incrementally during game, meaning no need for full re-calculation
     uint64_t computeZobristHash();
 
-    // Get locations of white or black pieces (bitboard)
-    // Uses bitwise OR operation to combine occupancy of all pieces of same color
-    // To get all occupied squares, combine these two functions with bitwise OR
-    uint64_t whitePieces();
-    uint64_t blackPieces();
+    // Get locations of white, black or all pieces (bitboard)
+    // Kept up to date by every move, no need to combine the piece bitboards
+    uint64_t whitePieces() const { return pos.color_occupancy[WHITE]; }
+    uint64_t blackPieces() const { return pos.color_occupancy[BLACK]; }
+    uint64_t occupiedSquares() const { return pos.occupied_squares; }
 
     // Functions for castling
     uint64_t getCastlingMoves(bool white); // Get currently possible castling moves for a king
     void updateRookCastling(bool white, int source); // Update castling rights when rook was moved or captured
+    static uint8_t rookCastlingRight(bool white, int square); // Castling right lost by a rook leaving or captured on the square
     void handleCastling(bool white, int target); // Perform castling by moving king and rook in correct places
     void undoCastling(bool white, bool kingside); // Undo castling, used by AI
 
-    // Helper to get all the attack squares of opponent (squares that are possible to attack)
-    // Also determines if king is in check and calculates the attack ray
-    void getAttackSquares(int enemy_king, const uint64_t& white_pieces, const uint64_t black_pieces, bool white);
+    // Helper to get all the attack squares of the side that moved (squares that are possible to attack)
+    // Pawns are shifted at once, the other pieces are looked up from the move tables
+    void getAttackSquares(uint64_t occupied, bool white);
+
+    // Squares a move of a piece other than the king has to land on
+    // All squares if not in check, the checker or the squares between it and the king in a single check, none in a double check
+    uint64_t checkMask(bool white) const;
 
     // Determine if the attacking ray can be blocked by any of the own pieces
     // Returns bool indicating result
@@ -114,10 +99,14 @@ private:
     bool isStalemate(bool white); // If not in check/mate, check for possibility of stalemate
 
     // Each time after applying a move set the new board state
-    // Includes check, checkmate and stalemate information
+    // Check information, pins of the side to move and attack squares of the side that moved
     // Only updating the necessary side
     void updateBoardState(bool white);
 
+    // Checkmate and stalemate of the side to move, only after game moves
+    // The search never pays for them on make-move, it finds them when a node has no moves
+    void updateGameOverState(bool white);
+
     // Calculate positional scores of pieces
     // Expensive function call since iterates over every piece, but only called after human applied move so no visible effect
     void updatePositionalScore();
@@ -127,31 +116,63 @@ public:
     The functions below are used directly by the chessAI in minimax
     **************************************************************/
 
-    // Undo stack and search history are cleared
-    void startNewSearch();
+    // Start a search on the given stack of the search thread, from ply 0
+    // Moves of the search are undone by copy-make or by unmake
+    void startNewSearch(SearchStack* stack, bool copy_make_search = false);
+
+    // Plies from the root of the search, index of the current node in the search stack
+    int getSearchPly() const;
 
     // Used for draw detection
     uint64_t getHashKey();
 
-    // Function for ChessAI to generate the legal moves
-    // Only handle queen promotions
-    // Fills the movelist taken as parameter depending if we are minimizing/maximizing (which turn)
-	// Sorts the moves with MVV-LVA (Most Valuable Victim - Least Valuable Aggressor) heuristic
-    void generateMoves(std::array<uint32_t, MAX_MOVES>& move_list, int& move_count, int depth, bool white, uint32_t move_hint);
+    // Zobrist key of the position after the move, without applying it
+    // Lets the search prefetch the TT cluster of the child before the expensive board state update
+    uint64_t keyAfter(uint32_t move, bool white) const;
+
+    // Check squares of each piece type and the pieces that discover a check when they leave their line to the enemy king
+    // Computed once per node, lets the search tell checking moves apart before making them
+    KingDanger getCheckSquares(bool white) const;
+    uint64_t getDiscoveredCheckers(bool white) const;
 
-	// Function for ChessAI to generate noisy moves
-	// Used for quiescence search to reduce horizon effect
-	// Consider captures to resolve immediate tactical volatility
-    // + only queen promotions
-	void generateNoisyMoves(std::array<uint32_t, MAX_MOVES>& move_list, int& move_count, bool white);
+    // Whether a move other than a promotion puts the enemy king in check, castling and en passant are always assumed to
+    bool givesCheck(uint32_t move, const KingDanger& king_danger, uint64_t discovered_checkers, bool white);
 
-    // Generate all legal moves sorted with endgame heuristic
+    // Move generators of the move picker
+    // Moves are appended to move_list from move_count on with their ordering score, the picker selects them in score order
+    // All of them generate with generateLegalMoves and score the appended moves after it
+    // Midgame generators only handle queen promotions
+
+    // Captures, en passant and promotions
+    // Scored with MVV-LVA (Most Valuable Victim - Least Valuable Aggressor), losing captures by SEE get a negative score
+    void generateCaptures(std::array<ScoredMove, MAX_MOVES>& move_list, int& move_count, bool white);
+
+    // All other legal moves, scored with the history heuristic (not for depth 0)
+    void generateQuiets(std::array<ScoredMove, MAX_MOVES>& move_list, int& move_count, int depth, bool white);
+
+    // Generate all legal moves scored with endgame heuristic
     // Check moves are highest priority, also prioritize passed pawn advancement and king centrality
-    void generateEndgameMoves(std::array<uint32_t, MAX_MOVES>& move_list, int& move_count, int depth, bool white, uint32_t move_hint);
+    void generateEndgameMoves(std::array<ScoredMove, MAX_MOVES>& move_list, int& move_count, int depth, bool white);
 
-	// Generate noisy moves sorted with endgame heuristic
+	// Generate noisy moves scored with endgame heuristic
 	// Noisy moves are captures and promotions + all check moves
-	void generateEndgameNoisyMoves(std::array<uint32_t, MAX_MOVES>& move_list, int& move_count, bool white);
+	void generateEndgameNoisyMoves(std::array<ScoredMove, MAX_MOVES>& move_list, int& move_count, bool white);
+
+    // Rebuild the full move of a compact TT move from the pieces on the board
+    // Encoded as the generators of the phase would encode it, the check bit only in endgame
+    // NULL_MOVE_32 if the move doesn't fit the board, it can still be illegal
+    uint32_t decodeMove(uint16_t move, bool white, bool endgame);
+
+    // Check a move rebuilt from the board (decoded TT move, killer) without generating moves
+    // True if the generators would produce this move in the current position
+    bool isLegalMove(uint32_t move, bool white, bool endgame);
+
+    // Rebuild a killer move from its key, NULL_MOVE_32 unless it's a legal quiet move in the current position
+    uint32_t quietMoveFromKey(uint16_t key, bool white);
+
+    // Check if the side has any legal move, stops at the first piece that can move
+    // The search scores mates from an empty move list, quiescence only generates captures and asks this instead
+    bool hasLegalMoves(bool white);
 
 	// Function for ChessAI to apply the move
 	// Takes the encoded move as a parameter and applies it to the board
@@ -162,6 +183,17 @@ public:
 	// Takes the encoded move as a parameter and undoes it
 	void undoMoveAI(uint32_t move, bool white);
 
+	// Pass the turn without moving, used by null move pruning
+	// Flips the side to move key, clears en passant and pushes undo info like a regular move
+	// The half-move clock restarts so repetitions aren't detected across the null move
+	// Always undone from the undo info, nothing but the keys and rights change even in copy-make searches
+	void applyNullMove(bool white);
+	void undoNullMove();
+
+	// Material of the knights, bishops, rooks and queens of a side
+	// Zugzwang is common when it is low, null move pruning depends on it
+	int getNonPawnMaterial(bool white) const;
+
     // Function to assign a score to the board
 	// Used for evaluation of the board state in midgame
 	int evaluateBoard();
@@ -176,10 +208,17 @@ public:
 	bool isGameOver();
 
     // Check for repetitions by threefold rule
+    // Scans the key history back to the last irreversible move, across the search root into the game
     bool isDrawByRepetition();
 
-    // Used in quiescence search for delta pruning noisy moves
-    int estimateCaptureValue(uint32_t move);
+    // Check if the side to move can reach a threefold repetition with its next move
+    // Looks up the key difference to each earlier position in the cuckoo table of reversible moves
+    bool hasUpcomingRepetition(bool white);
+
+    // Static exchange evaluation: material won or lost by the full capture sequence on the target square
+    // Both sides recapture with their least valuable piece, sliders behind the capturers join in (x-rays)
+    // Used for good/bad capture ordering and for pruning losing captures in quiescence search
+    int staticExchangeEvaluation(uint32_t move);
     int estimateEndgameCaptureValue(uint32_t move, bool white); // Bonus for passed pawn capturing
 
     // Get distance between kings
@@ -211,6 +250,45 @@ private:
     bool isCheckMove(const KingDanger& king_danger, int to, PieceType piece);
 
     int evaluateSingleKingSafety(int king_sq, bool white);
+
+    // Save the pin and attack data of the side to move before a move, and restore it on undo
+    // Later move picker stages generate moves after other moves have been searched from the node
+    void saveLegalityData(UndoInfo& undo) const;
+    void restoreLegalityData(const UndoInfo& undo);
+
+    // Pieces of both sides attacking a square with the given occupancy
+    uint64_t attackersTo(int square, uint64_t occupied) const;
+
+    // Add or remove a piece on the given squares
+    // Every change to piece_bitboards after initBoard goes through these so the occupancy stays in sync
+    // Squares stay free of the other color, the board occupancy is the union of both colors
+    void placePiece(bool white, PieceType piece, uint64_t squares) {
+        pos.piece_bitboards[white][piece] |= squares;
+        pos.color_occupancy[white] |= squares;
+        pos.occupied_squares = pos.color_occupancy[WHITE] | pos.color_occupancy[BLACK];
+    }
+    void removePiece(bool white, PieceType piece, uint64_t squares) {
+        pos.piece_bitboards[white][piece] &= ~squares;
+        pos.color_occupancy[white] &= ~squares;
+        pos.occupied_squares = pos.color_occupancy[WHITE] | pos.color_occupancy[BLACK];
+    }
+
+    // Occupancy recomputed from the piece bitboards, debug builds check it after every move
+    bool isOccupancyConsistent() const;
+
+    // Set-wise legal move generator of the side to move
+    // Occupancy, check mask and pins are read once per call instead of once per piece (getLegalMoves)
+    // Appends the moves of the set with score 0, promotions to a queen first and then to the underpromotions if asked
+    void generateLegalMoves(std::array<ScoredMove, MAX_MOVES>& move_list, int& move_count, GenType type, bool underpromotions, bool white);
+
+    // Pawn moves of generateLegalMoves from whole-bitboard shifts
+    // Targets are limited to allowed: the check mask, and the pin ray for a pinned pawn
+    void generatePawnMoves(std::array<ScoredMove, MAX_MOVES>& move_list, int& move_count, uint64_t pawns, uint64_t allowed,
+        uint64_t empty, uint64_t opponent, GenType type, bool underpromotions, bool white);
+
+    // Append a pawn move to every target, the pawn comes from target - offset
+    void addPawnMoves(std::array<ScoredMove, MAX_MOVES>& move_list, int& move_count, uint64_t targets, int offset,
+        MoveType move_type, bool underpromotions);
 };
 
 #endif BITBOARD_H
\ No newline at end of file
@@ -12,8 +12,10 @@ constexpr uint64_t FILE_H = 0x8080808080808080ULL;
 // Rank masks
 constexpr uint64_t RANK_1 = 0x00000000000000FFULL;
 constexpr uint64_t RANK_2 = 0x000000000000FF00ULL;
+constexpr uint64_t RANK_3 = 0x0000000000FF0000ULL;
 constexpr uint64_t RANK_4 = 0x00000000FF000000ULL;
 constexpr uint64_t RANK_5 = 0x000000FF00000000ULL;
+constexpr uint64_t RANK_6 = 0x0000FF0000000000ULL;
 constexpr uint64_t RANK_7 = 0x00FF000000000000ULL;
 constexpr uint64_t RANK_8 = 0xFF00000000000000ULL;
 
@@ -40,6 +42,22 @@ constexpr int INF = 2147483647; // Infinity
 
 // Desired size for transposition table in MB
 constexpr size_t DESIRED_TT_SIZE_MB = 128;
+constexpr size_t MIN_TT_SIZE_MB = 1; // Bounds of the size set at runtime
+constexpr size_t MAX_TT_SIZE_MB = 65536;
+constexpr size_t TT_CLEAR_BYTES_PER_THREAD = 64ULL * 1024 * 1024; // Smaller tables are cleared by a single thread
+constexpr int TT_HASHFULL_SAMPLE = 1000; // Clusters sampled for the hashfull estimate
+constexpr uint32_t TT_FILE_VERSION = 2; // Format version of saved tables, bump when the entry layout changes
+
+// Seed of the Zobrist key generator, saved tables are only valid with the same keys
+constexpr uint64_t ZOBRIST_SEED = 123456789;
+
+// Transposition table clusters and aging
+constexpr int TT_CLUSTER_SIZE = 6; // Entries per 64-byte cluster
+constexpr uint8_t TT_GENERATION_DELTA = 4; // Generation step per search, the lower 2 bits of gen_flag hold the flag
+constexpr int TT_GENERATION_CYCLE = 255 + TT_GENERATION_DELTA; // Keeps the age computation positive over the wrap-around
+constexpr int TT_GENERATION_MASK = 0xFC; // Generation bits of gen_flag
+constexpr int TT_AGE_WEIGHT = 8; // Plies of depth one search of age is worth when choosing the entry to replace
+constexpr int TT_NO_EVAL = -32768; // Static eval of an entry stored without one
 
 constexpr int UNASSIGNED = -1; // Sentinel value for unassigned variables
 
@@ -58,10 +76,32 @@ constexpr int MAX_DEPTH = 64;  // Maximum playsible search depth for minimax
 constexpr int MAX_SEARCH_DEPTH = 128; // Covers maximum plausible search depth for minimax + quiescence
 // 128 for alignment + would be an extreme case which is near impossible
 
+constexpr int KEY_HISTORY_SIZE = 256; // Position keys kept for repetition detection (power of 2 for masking)
+// Covers the 50-move window of the game (100 plies) plus a full search path
+constexpr int KEY_HISTORY_MASK = KEY_HISTORY_SIZE - 1;
+
+constexpr int CUCKOO_SIZE = 8192; // Slots of the cuckoo table of reversible moves (power of 2 for masking)
+// Holds the 3668 knight, bishop, rook, queen and king moves of both colors on an empty board
+
+constexpr int MAX_ITERATIVE_DEPTH = MAX_DEPTH - 2; // Deepest iteration a time managed search may start
+// Leaves room for the endgame check extension in the depth indexed tables
+
 constexpr int MAX_PLY_FROM_MATE = 128; // Max ply num to reach mate (64 turns) (adjustable)
 
 constexpr int MAX_QUIET_MOVES = 4; // Cap to limit the number of quiet moves stored
 
+// Time management
+constexpr int MOVE_OVERHEAD_MS = 30; // Reserved per move for the caller and the interop layer
+constexpr int DEFAULT_MOVES_TO_GO = 30; // Assumed moves left when the clock has no moves-to-go control
+constexpr int MAX_MOVES_TO_GO = 50; // Cap so a long time control doesn't starve the current move
+constexpr int HARD_LIMIT_SCALE = 4; // Hard limit as a multiple of the planned time
+constexpr float MAX_TIME_SHARE = 0.4f; // Never spend more than this share of the remaining clock on one move
+constexpr int SCORE_DROP_MARGIN = 30; // Score drop between iterations that extends the soft limit
+constexpr uint64_t TIME_CHECK_INTERVAL = 2047; // Poll the clock every 2048 nodes (mask)
+
+// Lazy SMP
+constexpr int MAX_SEARCH_THREADS = 64; // Upper bound for the configurable search thread count
+
 // Margin for delta pruning in q-search
 constexpr int DELTA_MARGIN_MIDGAME = 200;
 constexpr int DELTA_MARGIN_ENDGAME = 250;
@@ -3,12 +3,11 @@
 
 #include "BitboardConstants.hpp"
 #include "CustomTypes.hpp"
+#include "TimeManager.hpp"
 
 // Forward declaration of Bitboard class
 class Bitboard;
-
-/*
-The ChessAI structures a move in 32 bits:
+struct SearchThread;
 
 /*
 The ChessAI structures a move in 32 bits:
@@ -21,6 +20,13 @@ The ChessAI structures a move in 32 bits:
 0000 1111 0000 0000 0000 0000 0000 0000  -> promotion type (4 bits)
 0001 0000 0000 0000 0000 0000 0000 0000  -> check move (1 bit) (only considered in endgame)
 
+TT moves are compacted to 16 bits, the rest is rebuilt from the board (Bitboard::decodeMove):
+
+0000 0000 0011 1111  -> from (6 bits)
+0000 1111 1100 0000  -> to (6 bits)
+0111 0000 0000 0000  -> promotion piece type (3 bits), 0 (PAWN) if not a promotion
+
+NULL_MOVE (all bits set) can't be a real move since from and to would be the same square.
 */
 
 class ChessAI {
@@ -46,10 +52,52 @@ public:
     static PieceType promotion(uint32_t move) { return static_cast<PieceType>((move >> 24) & 0xF); }
     static bool isCheck(uint32_t move) { return (move >> 28) & 0x1; }
 
-    static bool isKillerMove(int from, int to, PieceType piece, int depth); // Check if move is a killer move by depth
+    // Compact a move for storing, NULL_MOVE_32 becomes NULL_MOVE
+    static uint16_t compactMove(uint32_t move) {
+        if (move == NULL_MOVE_32) return NULL_MOVE;
+        MoveType type = moveType(move);
+        bool promoting = type == PROMOTION || type == PROMOTION_CAPTURE;
+        return compactMove(from(move), to(move), promoting ? promotion(move) : EMPTY);
+    }
+    static uint16_t compactMove(int from, int to, PieceType promotion) {
+        return static_cast<uint16_t>((from & 0x3F) | ((to & 0x3F) << 6) | ((promotion == EMPTY ? 0 : (promotion & 0x7)) << 12));
+    }
+
+    // Extract data from a compact move
+    static int compactFrom(uint16_t move) { return move & 0x3F; }
+    static int compactTo(uint16_t move) { return (move >> 6) & 0x3F; }
+    static PieceType compactPromotion(uint16_t move) { return (move >> 12) ? static_cast<PieceType>((move >> 12) & 0x7) : EMPTY; }
+
+    static bool isKillerMove(int from, int to, PieceType piece, int ply); // Check if move is a killer move at the search ply
     static int getHistoryScore(int from, int to, PieceType piece); // Get history score of a move
 
 private:
+    /*************************
+    Root search driver
+    *************************/
+
+    // Lazy SMP driver shared by midgame and endgame search
+    // Starts the helper threads on copies of the board and runs the main iterative deepening search itself
+    // Stops the helpers once the main thread finishes, the main thread's last completed iteration decides the move
+    static uint32_t iterativeDeepening(std::unique_ptr<Bitboard>& board, const SearchLimits& limits, bool maximizing, bool endgame);
+
+    // Iterative deepening loop of a single thread
+    // Searches depth 1..max_depth, every iteration opens with an aspiration window around the previous score
+    // Root moves are reordered between iterations so the previous best move is always searched first
+    // The main thread stops early when the time manager says so, helpers run until they are stopped
+    static uint32_t searchIterations(SearchThread& thread, std::unique_ptr<Bitboard>& board, std::array<RootMove, MAX_MOVES>& root_moves,
+        int move_count, int max_depth, bool maximizing, bool endgame);
+
+    // Entry point of a helper thread, root moves are copied so every thread orders its own
+    static void helperSearch(SearchThread& thread, std::array<RootMove, MAX_MOVES> root_moves, int move_count,
+        int max_depth, bool maximizing, bool endgame);
+
+    // Search every root move once within (alpha, beta) at the given depth
+    // Moves the best move to the front of root_moves and orders the rest by their child TT scores
+    // Returns the best score (<= alpha on fail-low, >= beta on fail-high)
+    static int searchRoot(std::unique_ptr<Bitboard>& board, std::array<RootMove, MAX_MOVES>& root_moves, int move_count,
+        int depth, int alpha, int beta, bool maximizing, bool endgame);
+
     /*************************
     Midgame specific algorithm
     *************************/
@@ -57,7 +105,11 @@ private:
 	// Minimax algorithm with alpha-beta pruning
 	// Recursively evaluates the board by simulating moves and choosing the best one
 	// Alpha-beta pruning is used to reduce the number of nodes evaluated in the search tree
-    static int minimax(std::unique_ptr<Bitboard>& board, int depth, int alpha, int beta, bool maximizing);
+	// Principal variation search: moves after the first are searched with a null window and re-searched on fail-high
+	// Null move pruning cuts nodes where passing the turn still fails high, allow_null is false right after a null move
+	// Late quiet moves are searched with a reduced depth and re-searched at full depth if they beat alpha
+	// Shallow nodes far outside the window are cut by reverse futility pruning, razoring and futility pruning
+    static int minimax(std::unique_ptr<Bitboard>& board, int depth, int alpha, int beta, bool maximizing, bool allow_null = true);
 
 	// Quiescence search algorithm
 	// Searches for the best move in a noisy position (captures and promotions)
@@ -65,9 +117,9 @@ private:
 	static int quiescence(std::unique_ptr<Bitboard>& board, int alpha, int beta, bool maximizing);
 
 	// Get evaluation of the current board score
-	// Detect checkmate, stalemate, and evaluate the board based on material and positional advantages
+	// Evaluate the board based on material and positional advantages, mates are scored by the search
 	// Advantegeous positions are assigned higher scores for prioritization
-	static int evaluateBoard(std::unique_ptr<Bitboard>& board, int depth, bool maximizing);
+	static int evaluateBoard(std::unique_ptr<Bitboard>& board, bool maximizing);
 
 
 
@@ -79,7 +131,8 @@ private:
     // Minimax algorithm with alpha-beta pruning
     // Differs from midgame by extending search for moves that chech the opponent
     // Also moves are sorted with different heuristic
-    static int endgameMinimax(std::unique_ptr<Bitboard>& board, int depth, int alpha, int beta, bool maximizing);
+    // Null move pruning is off without pieces, and verified by a reduced search with few pieces left (zugzwang)
+    static int endgameMinimax(std::unique_ptr<Bitboard>& board, int depth, int alpha, int beta, bool maximizing, bool allow_null = true);
 
     // Quiescence search algorithm
     // Searches for the best move in a noisy position (captures and promotions)
@@ -87,11 +140,41 @@ private:
     static int endgameQuiescence(std::unique_ptr<Bitboard>& board, int alpha, int beta, bool maximizing);
 
     // Get evaluation of the current board score
-    // Detect checkmate, stalemate, and evaluate the board based on material and positional advantages
-    static int evaluateEndgameBoard(std::unique_ptr<Bitboard>& board, int depth, bool maximizing);
+    // Evaluate the board based on material and positional advantages, mates are scored by the search
+    static int evaluateEndgameBoard(std::unique_ptr<Bitboard>& board, bool maximizing);
 
 
 private: 
+    // Search control shared by all search functions
+    static TimeManager time_manager;
+    static SearchStats last_stats; // Counters of the previous search
+    static std::atomic<bool> stop_search; // Set once the hard limit is hit or the main thread is done, every node unwinds after it
+
+    // Lazy SMP threads, index 0 is the main thread
+    static std::vector<std::unique_ptr<SearchThread>> threads;
+    static int thread_count;
+    static bool copy_make; // Search boards undo moves by copying the saved position back
+    static thread_local SearchThread* current_thread; // Thread state of the search running on this OS thread
+
+    // Create or drop search threads to match thread_count
+    static void prepareThreads();
+
+    // Count the node and poll the clock periodically
+    // Returns true if the search has to unwind
+    static inline bool searchStopped();
+
+    // Late move reduction of a quiet move in the midgame search
+    // Base value from the log-log table, reduced less for killers, checks and moves with a good history
+    static int lateMoveReduction(uint32_t move, int depth, int ply, int move_index, bool gives_check);
+
+    // Depth reduction of the null move search
+    // Grows with the remaining depth and with how far the static eval is above beta
+    static int nullMoveReduction(int depth, int static_eval, int beta);
+
+    // Convert mate scores between root and node relative distance for the TT
+    static int scoreToTT(int score, int ply);
+    static int scoreFromTT(int score, int ply);
+
     // Helper to determine if a move is capture
     static inline bool isCapture(uint32_t move);
 
@@ -103,16 +186,29 @@ private:
     static uint16_t moveKey(uint32_t move);
     static uint16_t moveKey(int from, int to, PieceType piece); // Overloaded to generate move without decoding move
 
-    // Update killer moves and history heuristics
-    static void updateKillerMoves(uint32_t move, int depth);
+    // Update killer moves (by search ply) and history heuristics
+    static void updateKillerMoves(uint32_t move, int ply);
     static void updateHistory(uint32_t move, int depth);
 
 public:
-    // Change the parameter type of 'board' to a reference to a unique_ptr of Bitboard  
-    static uint32_t getBestMove(std::unique_ptr<Bitboard>& board, int depth, bool maximizing);
+    // Get the best move for the current board state within the search limits
+    // Limits are either a fixed depth or a clock for the time manager
+    static uint32_t getBestMove(std::unique_ptr<Bitboard>& board, const SearchLimits& limits, bool maximizing);
 
     // Get the best move for the current board state in endgame
-    static uint32_t getBestEndgameMove(std::unique_ptr<Bitboard>& board, int depth, bool maximizing);
+    static uint32_t getBestEndgameMove(std::unique_ptr<Bitboard>& board, const SearchLimits& limits, bool maximizing);
+
+    // Counters of the previous search, for measuring search changes
+    static const SearchStats& getLastSearchStats();
+
+    // Number of threads used by following searches (clamped to 1..MAX_SEARCH_THREADS)
+    static void setThreadCount(int count);
+
+    // Undo moves of following searches by copy-make instead of unmake
+    static void setCopyMake(bool enabled);
+
+    // Free the thread states and their heuristic tables
+    static void releaseThreads();
 
 };
 
@@ -26,6 +26,9 @@ public:
     // Initialize the chessboard
     ChessBoard();
 
+    // Copy the game with its own bitboard, used for cloning boards
+    ChessBoard(const ChessBoard& other);
+
     ~ChessBoard() = default; // unique_ptr handles bitboard cleanup
 
     // Get legal moves from the parameter square as a bitboard
@@ -41,6 +44,10 @@ public:
     // Determined by search depth
     void MakeMoveAI(int depth, bool maximizing);
 
+    // Get best move for ai within the time budget and apply it
+    // Takes the remaining clock, increment and moves to next time control, or a fixed per-move budget
+    void MakeMoveAITimed(int time_left_ms, int increment_ms, int moves_to_go, int move_time_ms, bool maximizing);
+
 
     // Return board state as a FEN string (Forsyth-Edwards Notation)
     // For starting position the FEN string would be: rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1
@@ -73,6 +80,9 @@ public:
     std::string GetPrevMove() const;
 
 private:
+    // Search with the given limits and apply the resulting move
+    void makeMoveAI(const SearchLimits& limits, bool maximizing);
+
     // Set previous move dynamically
     void UpdatePrevMove(const std::string& message);
 
@@ -11,8 +11,13 @@ extern "C" {
     // Function to create and initialize the board
     CHESSENGINE_API void* CreateBoard();
 
+    // Function to copy a board with its game history, the copy is independent of the original
+    // Returns a new board to be freed with DestroyBoard, null if the board is null
+    CHESSENGINE_API void* CloneBoard(void* board);
+
     // Function to destroy the board and free memory
     // Takes a void pointer to the board as parameter
+    // The shared tables are freed with the last board
     CHESSENGINE_API void DestroyBoard(void* board);
 
     // Get valid moves from a square as a bitboard
@@ -26,6 +31,53 @@ extern "C" {
     // Evaluate and execute the best move for white/black in bitboard
     CHESSENGINE_API void MakeBestMove(void* board, int depth, bool white);
 
+    // Evaluate and execute the best move for white/black within a time budget
+    // Takes the remaining clock, increment and moves until the next time control (0 if none) in milliseconds,
+    // or a fixed budget for this move with move_time_ms > 0 which overrides the clock
+    CHESSENGINE_API void MakeBestMoveTimed(void* board, int time_left_ms, int increment_ms, int moves_to_go, int move_time_ms, bool white);
+
+    // Set the number of search threads used by the engine (1 = single threaded)
+    // Shared by all boards, takes effect from the next search
+    CHESSENGINE_API void SetThreads(int threads);
+
+    // Undo moves in the search by copying the saved position back (copy-make) instead of reversing them (unmake)
+    // Shared by all boards, takes effect from the next search
+    CHESSENGINE_API void SetCopyMake(bool enabled);
+
+    // Select how bishop and rook attacks are looked up: 0 = magic, 1 = PEXT (BMI2), 2 = hyperbola quintessence (no attack tables)
+    // The fastest of magic and PEXT is chosen by CPUID when the DLL is loaded, call between searches
+    // Returns false if the CPU doesn't support the backend, the current one is kept then
+    CHESSENGINE_API bool SetSliderBackend(int backend);
+
+    // Slider backend in use, numbered as in SetSliderBackend
+    CHESSENGINE_API int GetSliderBackend();
+
+    // Micro-benchmark of a slider backend, returns lookups per second over the given number of random lookups
+    // Call between searches, 0 if the CPU doesn't support the backend
+    CHESSENGINE_API double BenchSliderBackend(int backend, int lookups);
+
+    // Resize the transposition table to the given size in MB (clamped to 1..65536), its content is lost
+    // Shared by all boards, set before CreateBoard to skip the allocation of the default size
+    CHESSENGINE_API void SetHashSize(int size_mb);
+
+    // Empty the transposition table, e.g. before analysing an unrelated position
+    CHESSENGINE_API void ClearHash();
+
+    // Permille of the transposition table filled by the previous search (sampled)
+    CHESSENGINE_API int GetHashfull();
+
+    // Save the transposition table to a file, returns false on failure
+    CHESSENGINE_API bool SaveHash(const char* path);
+
+    // Load a transposition table saved by SaveHash, the table takes the saved size
+    // Returns false if the file is missing or was written by another engine version, the table is then left as it was
+    // Call after CreateBoard, the Zobrist keys are needed to validate the file
+    CHESSENGINE_API bool LoadHash(const char* path);
+
+    // Counters of the previous search, summed over all search threads
+    // Nodes visited, null window searches and their fail-high re-searches (PVS), completed depth and time in milliseconds
+    CHESSENGINE_API void GetSearchStats(uint64_t* nodes, uint64_t* zero_window_searches, uint64_t* researches, int* depth, int64_t* time_ms);
+
     // Retvieve board state as fen, previous move, and game state, all in one JSON copied to output buffer
     // JSON
     /*
@@ -2,6 +2,8 @@
 #define CUSTOMTYPES_H
 
 #include <cstdint>
+#include <cstring>
+#include <type_traits>
 
 // Sides are assigned an enum
 enum Color : uint8_t {
@@ -44,6 +46,20 @@ enum Direction : int8_t {
     NONE = 0
 };
 
+// Move sets of the legal move generator
+enum GenType : uint8_t {
+    GEN_NOISY = 0, // Captures, en passant and promotions
+    GEN_QUIET = 1, // All other moves, castling included
+    GEN_ALL = 2
+};
+
+// Slider attack lookup backends (Sliders.hpp)
+enum SliderBackend : uint8_t {
+    SLIDER_MAGIC = 0,     // Magic multiply and shift into the attack tables
+    SLIDER_PEXT = 1,      // BMI2 parallel bit extract into the attack tables
+    SLIDER_HYPERBOLA = 2  // Hyperbola quintessence, no attack tables
+};
+
 // Enum for TT entry flags (bound type)
 // Using uint8_t to save space
 enum TTFlag : uint8_t {
@@ -54,15 +70,68 @@ enum TTFlag : uint8_t {
 };
 
 // The structure for each entry in the Transposition Table
+// Compressed to 10 bytes so a cluster of them fits a single cache line
+// Only the upper 16 bits of the Zobrist key are kept, the lower bits already select the cluster
 struct TTEntry {
-    uint64_t zobrist_key_verify = 0; // Store the full Zobrist key for verification
-    uint32_t best_move = NULL_MOVE_32;    // Best move found for this position
-    int16_t score = 0;             // Evaluation score (adjust type based on score range)
-    int8_t depth = -1;             // Depth searched (-1 indicates unused/invalid)
-    TTFlag flag = FLAG_NONE;       // Flag indicating score type (EXACT, LOWER, UPPER)
+    uint16_t key16 = 0;                // Upper bits of the Zobrist key for verification
+    uint16_t best_move = NULL_MOVE;    // Compact best move found for this position
+    int16_t score = 0;                 // Evaluation score, mate scores packed to the ends of the range
+    int16_t static_eval = 0;           // Static evaluation of the position, TT_NO_EVAL if not computed
+    int8_t depth = 0;                  // Depth searched
+    uint8_t gen_flag = 0;              // Search generation in the upper 6 bits, TTFlag in the lower 2
+
+    TTFlag flag() const { return static_cast<TTFlag>(gen_flag & 0x3); }
+    uint8_t generation() const { return gen_flag & 0xFC; }
+};
+static_assert(sizeof(TTEntry) == 10, "TTEntry must stay 10 bytes to fill a cluster");
+
+// Bucket of entries sharing one cache line, a probe reads a single line
+struct alignas(64) TTCluster {
+    TTEntry entries[TT_CLUSTER_SIZE];
+    uint8_t padding[64 - TT_CLUSTER_SIZE * sizeof(TTEntry)];
+};
+static_assert(sizeof(TTCluster) == 64, "TTCluster must be one cache line");
+
+// Unpacked copy of an entry, filled by a TT probe
+struct TTData {
+    uint16_t best_move; // Compact best move, NULL_MOVE if none
+    int score;          // Score relative to the node (mate distance not yet adjusted for the ply)
+    int static_eval;    // Static evaluation, TT_NO_EVAL if not computed
+    int depth;          // Depth searched
+    TTFlag flag;        // Bound type of the score
+};
+
+// Limits of a single search
+// A depth-only search leaves all the clock fields at 0
+struct SearchLimits {
+    int max_depth = 0;      // Deepest iteration to search
+    int time_left_ms = 0;   // Remaining time on the engine's clock
+    int increment_ms = 0;   // Increment per move
+    int moves_to_go = 0;    // Moves until the next time control, 0 if sudden death
+    int move_time_ms = 0;   // Fixed budget for this move, overrides the clock fields
+};
+
+// Counters of a single search, summed over all search threads
+struct SearchStats {
+    uint64_t nodes = 0;                // Nodes visited, quiescence included
+    uint64_t zero_window_searches = 0; // Moves after the first searched with a null window (PVS)
+    uint64_t researches = 0;           // Null window searches that failed high and were searched again
+    int depth = 0;                     // Deepest iteration the main thread completed
+    int64_t time_ms = 0;               // Wall time of the search
+};
+
+// Move at the root of the search
+// Scores are kept between iterative deepening iterations for root move ordering
+struct RootMove {
+    uint32_t move;  // Encoded move
+    int score;      // Score from the latest iteration (bound if the move failed low)
+    int tt_score;   // Score of the child TT entry after the move, -INF if none
+};
 
-    // Ensure struct is packed if necessary, though alignment might make it naturally packed.
-    // Check sizeof(TTEntry) to be sure. Let's assume 8+4+2+1+1 = 16 bytes (+ potential padding)
+// Move with its ordering score, filled by the move generators for the move picker
+struct ScoredMove {
+    uint32_t move;
+    int score;
 };
 
 // Board state is stored as a bitmask
@@ -115,6 +184,50 @@ struct BoardState {
     }
 };
 
+// Everything that describes a position, without the game history
+// Trivially copyable so a board is cloned and a copy-make search saves a position with a plain copy
+struct Position {
+    // Piece bitboards indexed by [color][pieceType]
+    uint64_t piece_bitboards[2][6];
+
+    // Occupancy of each color and of the whole board, updated with the piece bitboards
+    uint64_t color_occupancy[2];
+    uint64_t occupied_squares;
+
+    // Legality data of the side to move, set by updateBoardState
+    uint64_t blockers_for_king; // Pieces alone between the king and an enemy slider, pin rays are looked up from Tables::LINE
+    uint64_t checkers; // Enemy pieces giving check
+    uint64_t attack_squares; // Squares attacked by the side that moved, rays pass through the king
+
+    uint64_t hash_key; // Unique key updated incrementally after each move
+
+    // Lookup table for fast piece type checking, the color is found from the color occupancy
+    PieceType piece_at_square[64];
+
+    // Board state scores updated incrementally
+    int material_score;
+    int positional_score;
+    int game_phase_score;
+
+    // The square where a pawn can be captured en passant
+    // If not possible, set UNASSIGNED
+    int en_passant_target;
+
+    int half_moves; // Helps determine if a draw can be claimed
+    int ply_count; // = Half moves since game start (used for mate-distance -calculation)
+
+    // Store castling rights as a bitmask
+    // Bit 0 : White kingside(K)
+    // Bit 1 : White queenside(Q)
+    // Bit 2 : Black kingside(k)
+    // Bit 3 : Black queenside(q)
+    uint8_t castling_rights;
+
+    BoardState state; // Check, mate and draw flags
+};
+static_assert(std::is_trivially_copyable_v<Position>, "Position must be copyable with memcpy");
+static_assert(sizeof(Position) <= 256, "Position must fit four cache lines");
+
 // Save previous board states for faster state recovery in move undoing
 struct UndoInfo {
     // Save castling and en passant
@@ -131,18 +244,22 @@ struct UndoInfo {
 
     // Halfmove counter
     int half_moves;
-};
 
-// Pinned piece data
-struct PinData {
-    uint64_t pinned;       // All pinned pieces
-    uint64_t pin_rays[64]; // Store pin ray for each pinned square
+    // Pin, check and attack data of the side to move, overwritten by the board state update of the move
+    uint64_t blockers_for_king;
+    uint64_t checkers;
+    uint64_t attack_squares;
 };
 
-// Attack data, store enemy attacks squares and attacker ray
-struct AttackData {
-    uint64_t attack_squares;
-    uint64_t attack_ray;
+// Per-ply data of the search, every search thread owns a fixed array of them
+// Entry n holds what the search needs at ply n from the root, and the state the move made at ply n is undone with
+// Aligned to cache lines so neighbouring plies don't share one
+struct alignas(64) SearchStack {
+    UndoInfo undo;          // Board state before the move of this ply
+    uint32_t current_move;  // Move being searched at this ply
+    int static_eval;        // Static evaluation of the node, 0 if not computed
+    uint16_t killers[2];    // Two best non-capture moves that caused a cutoff at this ply
+    Position position;      // Whole position before the move of this ply, only saved by copy-make searches
 };
 
 // Each direction king can get attacked from
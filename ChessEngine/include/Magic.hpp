@@ -1,27 +1,113 @@
 #ifndef MAGIC_H
 #define MAGIC_H
 
+#include "Utils.hpp"
+
 namespace Magic {
     // Magic movetable definition for rooks and bishops (+queen)
+    // Fancy magics: every square indexes its own slice of a shared packed attack table
     struct MagicMoves {
         uint64_t mask; // Bit-mask for moves
         uint64_t magic; // Magic moves
         int shift; // Bit shifts
+        uint32_t offset; // Start of the square's slice in MAGIC_ATTACKS
+        uint32_t pext_offset; // Start of the square's slice in PEXT_ATTACKS
     };
 
-    // Declare tables
-    extern MagicMoves MAGIC_TABLE_BISHOP[64];
-    extern MagicMoves MAGIC_TABLE_ROOK[64];
+    // Relevant occupancy masks, the edge squares of each ray left out
+    constexpr uint64_t maskBishopAttackRays(int square) {
+        uint64_t attacks = 0ULL;
+
+        // Get rank and file
+        int rank = Utils::getRank(square);
+        int file = Utils::getFile(square);
+
+        // Generate attack rays
+        for (int r = rank + 1, f = file + 1; r < 7 && f < 7; r++, f++) attacks |= (1ULL << Utils::getSquare(r, f));
+        for (int r = rank + 1, f = file - 1; r < 7 && f > 0; r++, f--) attacks |= (1ULL << Utils::getSquare(r, f));
+        for (int r = rank - 1, f = file + 1; r > 0 && f < 7; r--, f++) attacks |= (1ULL << Utils::getSquare(r, f));
+        for (int r = rank - 1, f = file - 1; r > 0 && f > 0; r--, f--) attacks |= (1ULL << Utils::getSquare(r, f));
+
+        return attacks;
+    }
+
+    constexpr uint64_t maskRookAttackRays(int square) {
+        uint64_t attacks = 0ULL;
 
-    uint64_t maskRookXrayAttacks(int square, uint64_t blockers);
-    uint64_t maskBishopXrayAttacks(int square, uint64_t blockers);
+        // Get rank and file
+        int rank = Utils::getRank(square);
+        int file = Utils::getFile(square);
 
-    extern std::atomic<bool> initialized; // Track re-init need
-    void initMagicTables();
-    void teardownTables();
+        // Generate attack rays
+        for (int r = rank + 1; r < 7; r++) attacks |= (1ULL << Utils::getSquare(r, file));
+        for (int r = rank - 1; r > 0; r--) attacks |= (1ULL << Utils::getSquare(r, file));
+        for (int f = file + 1; f < 7; f++) attacks |= (1ULL << Utils::getSquare(rank, f));
+        for (int f = file - 1; f > 0; f--) attacks |= (1ULL << Utils::getSquare(rank, f));
 
-    static bool isInitialized() {
-        return initialized.load(std::memory_order_acquire);
+        return attacks;
+    }
+
+    // Attacks of a slider with the given blockers, the blockers themselves included
+    constexpr uint64_t maskBishopXrayAttacks(int square, uint64_t blockers) {
+        uint64_t attacks = 0ULL;
+
+        // Get rank and file
+        int rank = Utils::getRank(square);
+        int file = Utils::getFile(square);
+
+        // Generate xrays, stop traversing a ray after encountering a blocker
+        for (int r = rank + 1, f = file + 1; r < 8 && f < 8; r++, f++) {
+            attacks |= (1ULL << Utils::getSquare(r, f));
+            if ((1ULL << Utils::getSquare(r, f) & blockers)) break;
+        }
+
+        for (int r = rank + 1, f = file - 1; r < 8 && f >= 0; r++, f--) {
+            attacks |= (1ULL << Utils::getSquare(r, f));
+            if ((1ULL << Utils::getSquare(r, f) & blockers)) break;
+        }
+
+        for (int r = rank - 1, f = file + 1; r >= 0 && f < 8; r--, f++) {
+            attacks |= (1ULL << Utils::getSquare(r, f));
+            if ((1ULL << Utils::getSquare(r, f) & blockers)) break;
+        }
+
+        for (int r = rank - 1, f = file - 1; r >= 0 && f >= 0; r--, f--) {
+            attacks |= (1ULL << Utils::getSquare(r, f));
+            if ((1ULL << Utils::getSquare(r, f) & blockers)) break;
+        }
+
+        return attacks;
+    }
+
+    constexpr uint64_t maskRookXrayAttacks(int square, uint64_t blockers) {
+        uint64_t attacks = 0ULL;
+
+        // Get rank and file
+        int rank = Utils::getRank(square);
+        int file = Utils::getFile(square);
+
+        // Generate xrays, stop traversing a ray after encountering a blocker
+        for (int r = rank + 1; r < 8; r++) {
+            attacks |= (1ULL << Utils::getSquare(r, file));
+            if ((1ULL << Utils::getSquare(r, file) & blockers)) break;
+        }
+
+        for (int r = rank - 1; r >= 0; r--) {
+            attacks |= (1ULL << Utils::getSquare(r, file));
+            if ((1ULL << Utils::getSquare(r, file) & blockers)) break;
+        }
+
+        for (int f = file + 1; f < 8; f++) {
+            attacks |= (1ULL << Utils::getSquare(rank, f));
+            if ((1ULL << Utils::getSquare(rank, f) & blockers)) break;
+        }
+
+        for (int f = file - 1; f >= 0; f--) {
+            attacks |= (1ULL << Utils::getSquare(rank, f));
+            if ((1ULL << Utils::getSquare(rank, f) & blockers)) break;
+        }
+
+        return attacks;
     }
 
     // Tables for relevant bits count
@@ -47,6 +133,30 @@ namespace Magic {
         12, 11, 11, 11, 11, 11, 11, 12,
     };
 
+    // Bits of the magic index of each square, 64 - shift
+    // Equal to the relevant bits unless tools/MagicSearch.cpp found a denser magic
+    constexpr int INDEX_BITS_BISHOP[64] = {
+            6, 5, 5, 5, 5, 5, 5, 6,
+            5, 5, 5, 5, 5, 5, 5, 5,
+            5, 5, 7, 7, 7, 7, 5, 5,
+            5, 5, 7, 9, 9, 7, 5, 5,
+            5, 5, 7, 9, 9, 7, 5, 5,
+            5, 5, 7, 7, 7, 7, 5, 5,
+            5, 5, 5, 5, 5, 5, 5, 5,
+            6, 5, 5, 5, 5, 5, 5, 6,
+    };
+
+    constexpr int INDEX_BITS_ROOK[64] = {
+        12, 11, 11, 11, 11, 11, 11, 12,
+        11, 10, 10, 10, 10, 10, 10, 11,
+        11, 10, 10, 10, 10, 10, 10, 11,
+        11, 10, 10, 10, 10, 10, 10, 11,
+        11, 10, 10, 10, 10, 10, 10, 11,
+        11, 10, 10, 10, 10, 10, 10, 11,
+        11, 10, 10, 10, 10, 10, 10, 11,
+        12, 11, 11, 11, 11, 11, 11, 12,
+    };
+
     // Magic tables for sliding piece move generations
     constexpr uint64_t MAGICS_BISHOP[64] = {
           0x40040844404084ULL,
@@ -181,6 +291,24 @@ namespace Magic {
           0x2006104900a0804ULL,
           0x1004081002402ULL
     };
+
+    // Entries of packed slices of the given index bits
+    constexpr size_t packedSize(const int (&index_bits)[64]) {
+        size_t size = 0;
+        for (int bits : index_bits) size += size_t(1) << bits;
+        return size;
+    }
+
+    // Upper bound for magics, slices end at the highest index the magic uses and may leave the end of the table empty
+    constexpr size_t MAGIC_ATTACKS_SIZE = packedSize(INDEX_BITS_BISHOP) + packedSize(INDEX_BITS_ROOK);
+    constexpr size_t PEXT_ATTACKS_SIZE = packedSize(RELEVANT_BITS_COUNT_BISHOP) + packedSize(RELEVANT_BITS_COUNT_ROOK);
+
+    // Generated at compile time, read-only data of the DLL image
+    // The pages are shared by every process running the engine and only touched if their backend is used
+    extern const std::array<MagicMoves, 64> MAGIC_TABLE_BISHOP;
+    extern const std::array<MagicMoves, 64> MAGIC_TABLE_ROOK;
+    extern const std::array<uint64_t, MAGIC_ATTACKS_SIZE> MAGIC_ATTACKS; // Bishop slices first, magic index order
+    extern const std::array<uint64_t, PEXT_ATTACKS_SIZE> PEXT_ATTACKS;   // Bishop slices first, PEXT index order
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,76 @@
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include "BitboardConstants.hpp"
+#include "CustomTypes.hpp"
+
+// Forward declaration of Bitboard class
+class Bitboard;
+
+/*
+The MovePicker hands out the moves of a node one at a time, in stages:
+
+TT move       -> checked on the board, no generation needed
+good captures -> captures and queen promotions not losing material (SEE), MVV-LVA order
+killers       -> the two killer moves of the ply, if they are legal quiet moves here
+quiet moves   -> history heuristic order
+bad captures  -> captures losing material, MVV-LVA order
+
+A stage is only generated once the earlier ones are searched, so a cutoff by the TT move
+or a capture never generates the quiet moves. Each move is selected as the best scored
+of the remaining ones instead of sorting the whole list up front.
+
+Quiescence only runs the capture stages. Endgame search keeps its own ordering heuristic:
+TT move first, then the endgame generator's moves in score order.
+*/
+
+class MovePicker {
+private:
+    enum Stage : uint8_t {
+        TT_MOVE,
+        GENERATE_CAPTURES,
+        GOOD_CAPTURES,
+        KILLERS,
+        GENERATE_QUIETS,
+        QUIETS,
+        BAD_CAPTURES,
+        GENERATE_ALL, // Quiescence and endgame: one generator, picked in score order
+        ALL_MOVES,
+        DONE
+    };
+
+    Bitboard& board;
+    bool white;
+    bool endgame;
+    bool quiescence;
+    int depth;
+    Stage stage;
+
+    uint16_t tt_key; // Compact TT move, decoded by the TT stage
+    uint32_t tt_move; // Decoded TT move, NULL_MOVE_32 if none
+    const uint16_t* killer_keys; // Killers of the ply in the search stack, nullptr if none
+    uint32_t killers[2]; // Killers handed out by the killer stage, skipped among the quiet moves
+    int killer_index;
+
+    std::array<ScoredMove, MAX_MOVES> moves;
+    int current; // Next move to select from
+    int end; // End of the moves of the current stage
+    int bad_captures_begin; // Bad captures are left in [bad_captures_begin, bad_captures_end) by the good capture stage
+    int bad_captures_end;
+
+    // Swap the best scored move of [current, end) to current
+    ScoredMove& selectBest();
+
+public:
+    // Main search picker
+    // The compact TT move is decoded and validated before it is handed out, killer_keys may be nullptr (root)
+    MovePicker(Bitboard& board, bool white, uint16_t tt_key, const uint16_t* killer_keys, int depth, bool endgame);
+
+    // Quiescence search picker: captures and queen promotions, in endgame all noisy moves
+    MovePicker(Bitboard& board, bool white, bool endgame);
+
+    // Next move to search, NULL_MOVE_32 once every move has been handed out
+    uint32_t nextMove();
+};
+
+#endif // MOVEPICKER_H
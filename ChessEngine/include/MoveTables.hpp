@@ -17,24 +17,11 @@ namespace MoveTables {
 		uint64_t moves;         // Can move one step in each direction
 	};
 
-	// Declare tables
-	extern PawnMoves WHITE_PAWN_MOVES[64];
-	extern PawnMoves BLACK_PAWN_MOVES[64];
-	extern KnightMoves KNIGHT_MOVES[64];
-	extern KingMoves KING_MOVES[64];
-
-	// Bishops and rook moves are initialize on the heap because of the large size
-	extern uint64_t(*ATTACKS_BISHOP)[512];
-	extern uint64_t(*ATTACKS_ROOK)[4096];
-
-	// Generate move tables at runtime
-	// Loops over the 64 squares of the chessboard and creates moveset for each piece at each location
-	// Calls every individual init function of each piece
-	extern std::atomic<bool> initialized; // Flag to track need of re-initialization
-	void initMoveTables();
-
-	// Deallocate slider tables when program exits
-	void teardownMoveTables();
+	// Tables generated at compile time
+	extern const std::array<PawnMoves, 64> WHITE_PAWN_MOVES;
+	extern const std::array<PawnMoves, 64> BLACK_PAWN_MOVES;
+	extern const std::array<KnightMoves, 64> KNIGHT_MOVES;
+	extern const std::array<KingMoves, 64> KING_MOVES;
 }
 
 #endif // MOVETABLES_H
\ No newline at end of file
@@ -23,10 +23,10 @@ public:
     static uint64_t getRookMoves(int rook, uint64_t occ);
     static uint64_t getQueenMoves(int queen, uint64_t occupied);
 
-    // Compute pinned pieces 
-    // Fills into pin_data reference param
-    static void computePinnedPieces(PinData& pin_data, const int& king_sq, const uint64_t& occupied,
-        const uint64_t& bishops, const uint64_t& rooks, const uint64_t& queen);
+    // Compute pieces of either color standing alone between the king and an aligned enemy slider
+    // The sliders are found at once from slider attacks of the king square on an empty board (x-ray)
+    // A friendly blocker is pinned to Tables::LINE[king_sq][square]
+    static uint64_t computeKingBlockers(int king_sq, uint64_t occupied, uint64_t diagonal_sliders, uint64_t orthogonal_sliders);
 
     // Compute squares where enemy can check the king
     // 
@@ -4,9 +4,39 @@
 // --- Heavy mate prioritization for minimax and eval ---
 constexpr int MATE_SCORE = 100000; 
 
+// --- Aspiration windows ---
+constexpr int ASPIRATION_WINDOW = 35; // Initial half-width of the window around the previous iteration's score
+constexpr int ASPIRATION_MAX_WINDOW = 1000; // Window width after which we give up and search with the full window
+constexpr int ASPIRATION_MIN_DEPTH = 4; // Shallow iterations are cheap and too unstable, search them with the full window
+
+// --- Frontier pruning ---
+// Margins indexed by remaining depth
+constexpr int RFP_MAX_DEPTH = 3; // Reverse futility pruning up to this depth
+constexpr int RFP_MARGIN = 120; // Static eval has to beat beta by this much per ply of depth
+constexpr int RAZOR_MAX_DEPTH = 3; // Razoring up to this depth
+constexpr int RAZOR_MARGINS[RAZOR_MAX_DEPTH + 1] = { 0, 300, 450, 600 }; // Eval this far below alpha drops into quiescence
+constexpr int FUTILITY_MAX_DEPTH = 3; // Futility pruning up to this depth
+constexpr int FUTILITY_MARGINS[FUTILITY_MAX_DEPTH + 1] = { 0, 200, 350, 500 }; // Best gain a quiet move is assumed to make
+
+// --- Null move pruning ---
+constexpr int NULL_MOVE_MIN_DEPTH = 3; // Remaining depth needed to try a null move
+constexpr int NULL_MOVE_REDUCTION = 2; // Base reduction R of the null move search
+constexpr int NULL_MOVE_DEPTH_DIVISOR = 4; // R grows by one for every this many plies of remaining depth
+constexpr int NULL_MOVE_EVAL_DIVISOR = 200; // R grows by one for every this much static eval above beta
+constexpr int NULL_MOVE_MAX_EVAL_REDUCTION = 2; // Cap for the eval based part of R
+constexpr int NULL_MOVE_VERIFY_MATERIAL = 500; // Endgame: verify null move cutoffs when the side to move has at most a rook's worth of pieces
+
+// --- Late move reductions ---
+constexpr float LMR_BASE = 0.75f; // Reduction = LMR_BASE + log(depth) * log(move index) / LMR_DIVISOR
+constexpr float LMR_DIVISOR = 2.25f;
+constexpr int LMR_MIN_DEPTH = 3; // Remaining depth needed to reduce
+constexpr int LMR_MIN_MOVE_INDEX = 3; // Moves before this index are never reduced (TT move, good captures, killers)
+constexpr int LMR_HISTORY_DIVISOR = 2000; // One ply less reduction for every this much history score
+constexpr int LMR_MAX_HISTORY_BONUS = 2; // Cap for the history adjustment
+
 // --- Move ordering scoring ---
-constexpr int KILLER_SCORE = 9000; // Score to prioritize killer moves
-constexpr int TT_MOVE_SCORE = 100000; // Score for TT-hint moves
+// TT move and killers are picked in their own stages, scores order the moves within a stage
+constexpr int BAD_CAPTURE_SCORE = -20000; // Added to MVV-LVA for captures that lose material (SEE < 0), the negative score marks them for the last stage
 constexpr int QUEEN_PROMOTION = 20000; // Huge priority for queen promotion
 constexpr int ROOK_PROMOTION = 8000; // Priority for rook promotion, lower than queen but higher than most captures
 constexpr int BN_PROMOTION = 1500; // Bishop/knight promotions equal to minor captures (tactical)
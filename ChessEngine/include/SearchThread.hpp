@@ -0,0 +1,50 @@
+#ifndef SEARCHTHREAD_H
+#define SEARCHTHREAD_H
+
+#include "BitboardConstants.hpp"
+#include "CustomTypes.hpp"
+#include "Bitboard.hpp"
+
+/*
+Lazy SMP runs the same iterative deepening search on several threads at once.
+The threads only talk to each other through the shared transposition table,
+everything else a search writes to is owned by one SearchThread:
+
+id            -> 0 is the main thread, it polls the clock and picks the move
+board         -> helpers search a private copy of the root position
+search stack  -> per-ply undo info (or the whole position in copy-make), static eval, current move and killers
+history table -> score of quiet moves by move key
+
+The search stack is a fixed array, applying and undoing moves never touches the heap.
+The history table persists between searches of the same game, the stack is cleared for every search.
+*/
+
+struct SearchThread {
+    int id;
+    std::unique_ptr<Bitboard> board; // Unused by the main thread, it searches the game board itself
+    std::thread worker;
+
+    SearchStack stack[MAX_SEARCH_DEPTH]; // Indexed by ply from the root
+    std::unique_ptr<int[]> history_table; // History heuristic: use move keys for lookup (uint16_t)
+    // Heap allocated for the large size
+
+    SearchStats stats; // Counters of the current search
+
+    explicit SearchThread(int thread_id) :
+        id(thread_id),
+        history_table(new int[MAX_HISTORY_KEY]()) // Zero-initialized array
+    {
+        clearStack();
+    }
+
+    // Reset the per-ply search data before a new search
+    void clearStack() {
+        for (SearchStack& entry : stack) {
+            entry.current_move = NULL_MOVE_32;
+            entry.static_eval = 0;
+            entry.killers[0] = entry.killers[1] = NULL_MOVE;
+        }
+    }
+};
+
+#endif // SEARCHTHREAD_H
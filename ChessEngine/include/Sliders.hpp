@@ -0,0 +1,114 @@
+#ifndef SLIDERS_H
+#define SLIDERS_H
+
+#include "BitboardConstants.hpp"
+#include "CustomTypes.hpp"
+#include "Magic.hpp"
+#include "Utils.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#define SLIDERS_HAS_PEXT
+#if defined(_MSC_VER)
+#define SLIDERS_TARGET_BMI2
+#else
+#define SLIDERS_TARGET_BMI2 __attribute__((target("bmi2")))
+#endif
+#endif
+
+/*
+Bishop and rook attacks are looked up by one of three backends:
+
+SLIDER_MAGIC     -> occupancy under the mask multiplied by a magic and shifted into the square's slice of Magic::MAGIC_ATTACKS
+SLIDER_PEXT      -> occupancy bits under the mask gathered by BMI2 PEXT into the square's slice of Magic::PEXT_ATTACKS
+SLIDER_HYPERBOLA -> hyperbola quintessence, o ^ (o - 2r) on each line, never touches the attack tables (about 3 KB of masks)
+
+All lookup data is generated at compile time, switching backends only changes which table is read.
+MAGIC_ATTACKS and PEXT_ATTACKS are separate tables of about 840 KB each, the image carries both (about 1.7 MB).
+The backend is picked by CPUID when the DLL is loaded, PEXT wherever BMI2 isn't microcoded.
+Hyperbola is never picked automatically, it's for hosts running many engines that share the caches.
+*/
+
+namespace Sliders {
+    extern SliderBackend backend; // Backend of Moves::getBishopMoves/getRookMoves, set by setBackend
+
+    // Lines through a square for hyperbola quintessence, the square itself excluded
+    extern const std::array<uint64_t, 64> FILE_MASKS;
+    extern const std::array<uint64_t, 64> DIAGONAL_MASKS;      // a1-h8 direction
+    extern const std::array<uint64_t, 64> ANTI_DIAGONAL_MASKS; // h1-a8 direction
+
+    // Rank attacks of a slider on the first rank, indexed by the 6 inner occupancy bits and the file
+    extern const std::array<std::array<uint64_t, 8>, 64> FIRST_RANK_ATTACKS;
+
+    // Fastest backend of the running CPU
+    // PEXT if BMI2 is available, except on AMD before Zen 3 where PEXT is microcoded and slower than magic
+    SliderBackend detectBackend();
+
+    // Whether the running CPU can use the backend
+    bool isSupported(SliderBackend slider_backend);
+
+    // Make the backend the active one, magic if the CPU can't run it
+    // Must not be called while a search is running
+    void setBackend(SliderBackend slider_backend);
+
+    // Micro-benchmark: slider lookups per second of a backend over random squares and occupancies
+    // Switches to the backend for the run and back afterwards, returns 0 if the backend isn't supported
+    double benchmark(SliderBackend slider_backend, int lookups);
+
+    /*************************
+    Backend lookups
+    *************************/
+
+    inline uint64_t bishopAttacksMagic(int square, uint64_t occupied) {
+        const Magic::MagicMoves& entry = Magic::MAGIC_TABLE_BISHOP[square];
+        return Magic::MAGIC_ATTACKS[entry.offset + (((occupied & entry.mask) * entry.magic) >> entry.shift)];
+    }
+
+    inline uint64_t rookAttacksMagic(int square, uint64_t occupied) {
+        const Magic::MagicMoves& entry = Magic::MAGIC_TABLE_ROOK[square];
+        return Magic::MAGIC_ATTACKS[entry.offset + (((occupied & entry.mask) * entry.magic) >> entry.shift)];
+    }
+
+#ifdef SLIDERS_HAS_PEXT
+    SLIDERS_TARGET_BMI2 inline uint64_t bishopAttacksPext(int square, uint64_t occupied) {
+        const Magic::MagicMoves& entry = Magic::MAGIC_TABLE_BISHOP[square];
+        return Magic::PEXT_ATTACKS[entry.pext_offset + _pext_u64(occupied, entry.mask)];
+    }
+
+    SLIDERS_TARGET_BMI2 inline uint64_t rookAttacksPext(int square, uint64_t occupied) {
+        const Magic::MagicMoves& entry = Magic::MAGIC_TABLE_ROOK[square];
+        return Magic::PEXT_ATTACKS[entry.pext_offset + _pext_u64(occupied, entry.mask)];
+    }
+#else
+    // Never selected without PEXT, isSupported rejects it
+    inline uint64_t bishopAttacksPext(int square, uint64_t occupied) { return bishopAttacksMagic(square, occupied); }
+    inline uint64_t rookAttacksPext(int square, uint64_t occupied) { return rookAttacksMagic(square, occupied); }
+#endif
+
+    // Attacks along one line through the square, the byte swap mirrors the ranks so the subtraction also runs downwards
+    inline uint64_t lineAttacks(int square, uint64_t occupied, uint64_t line_mask) {
+        uint64_t slider = 1ULL << square;
+        uint64_t forward = occupied & line_mask;
+        uint64_t reverse = Utils::byteSwap(forward);
+        forward -= slider;
+        reverse -= Utils::byteSwap(slider);
+        return (forward ^ Utils::byteSwap(reverse)) & line_mask;
+    }
+
+    // Ranks can't be mirrored by a byte swap, the rank is shifted to the first rank and looked up instead
+    inline uint64_t rankAttacks(int square, uint64_t occupied) {
+        int rank_shift = square & 56;
+        int inner_occupancy = static_cast<int>((occupied >> rank_shift) >> 1) & 63;
+        return FIRST_RANK_ATTACKS[inner_occupancy][square & 7] << rank_shift;
+    }
+
+    inline uint64_t bishopAttacksHyperbola(int square, uint64_t occupied) {
+        return lineAttacks(square, occupied, DIAGONAL_MASKS[square]) | lineAttacks(square, occupied, ANTI_DIAGONAL_MASKS[square]);
+    }
+
+    inline uint64_t rookAttacksHyperbola(int square, uint64_t occupied) {
+        return lineAttacks(square, occupied, FILE_MASKS[square]) | rankAttacks(square, occupied);
+    }
+}
+
+#endif // SLIDERS_H
@@ -4,32 +4,87 @@
 #include "BitboardConstants.hpp"
 #include "CustomTypes.hpp"
 
+#ifdef _MSC_VER
+#include <xmmintrin.h>
+#endif
+
 namespace Tables {
-	// Pre-compute all attack rays between squares
-	extern uint64_t BETWEEN[64][64];
-	extern uint64_t LINE[64][64];
-	extern Direction DIR[64][64];
+	// Table indexed by two squares
+	template <typename T>
+	using SquareTable = std::array<std::array<T, 64>, 64>;
 
-	// Killer move table: stores two best non-capture moves per depth
-	extern uint16_t KILLER_MOVES[MAX_DEPTH][2];
+	// Pre-compute all attack rays between squares, generated at compile time
+	extern const SquareTable<uint64_t> BETWEEN;
+	extern const SquareTable<uint64_t> LINE;
+	extern const SquareTable<Direction> DIR;
 
-	// History heuristic: assigns a score to quiet moves
-	extern int* HISTORY_TABLE; // Use move keys for lookup (uint16_t)
-	// Initialized on the heap for the large size
+	// Late move reduction by remaining depth and move index
+	// Precomputed log(depth) * log(index) curve, adjusted per move in the search
+	extern int8_t LMR_REDUCTIONS[MAX_DEPTH][MAX_MOVES];
 
 	// Transposition Table for efficient alpha-beta pruning in minimax
-	extern TTEntry* TRANSPOSITION_TABLE; 
+	// Clusters of entries, one cache line each, selected by the lower bits of the key
+	extern TTCluster* TRANSPOSITION_TABLE; 
 	// Initialized on the heap for the large size
-	extern size_t TT_NUM_ENTRIES; // Number of entries (will be power of 2)
-	extern size_t TT_MASK;        // Mask for indexing (num_entries - 1)
+	extern size_t TT_NUM_CLUSTERS; // Number of clusters (will be power of 2)
+	extern size_t TT_MASK;         // Mask for indexing (num_clusters - 1)
+	extern uint8_t TT_GENERATION;  // Generation of the current search, entries of older searches are replaced first
+	extern size_t TT_SIZE_MB;      // Size used by the next allocation, kept over teardowns
+
+	// Access to the transposition table, shared by all search threads without locks
+	// Probe unpacks the entry of the position and refreshes its generation, returns false if the cluster doesn't hold it
+	// Store reuses the entry of the same position, otherwise replaces the entry with the lowest depth minus age
+	// A torn entry can only hand out a wrong move, which the move picker rejects by its legality check
+	bool probeTT(uint64_t key, TTData& data);
+	void storeTT(uint64_t key, uint16_t best_move, int score, int static_eval, int depth, TTFlag flag);
+
+	// Start loading the cluster of the key into the cache, the probe after the move then finds it there
+	inline void prefetchTT(uint64_t key) {
+		if (!TRANSPOSITION_TABLE) return;
+#ifdef _MSC_VER
+		_mm_prefetch(reinterpret_cast<const char*>(&TRANSPOSITION_TABLE[key & TT_MASK]), _MM_HINT_T0);
+#else
+		__builtin_prefetch(&TRANSPOSITION_TABLE[key & TT_MASK]);
+#endif
+	}
+
+	// Start a new search generation, called once per search before the threads start
+	void newSearchTT();
+
+	// Runtime management of the table, never called while a search is running
+	// Resize reallocates an allocated table right away, otherwise the size is used by the next initTables
+	// Clear zeroes the table with several threads on large tables
+	// Hashfull is the permille of sampled entries written by the current search
+	void resizeTT(size_t size_in_mb);
+	void clearTT();
+	int hashfullTT();
+
+	// Save the table to a file and load it back, e.g. to resume analysis after a restart
+	// The file starts with a header of the format version, entry layout and Zobrist keys it was written with
+	// Loading maps the file, rejects files of another version or other keys, and resizes the table to the saved size
+	// Return false on failure, a rejected file leaves the table as it was
+	bool saveTT(const char* path);
+	bool loadTT(const char* path);
 
 	// Tables for zobrist hashing key generation
-	extern uint64_t PIECE_KEYS[2][6][64]; // Piece position keys
-	extern uint64_t SIDE_TO_MOVE_KEY;     // Side to move key
-	extern uint64_t CASTLING_KEYS[16];    // Castling rights
-	extern uint64_t EN_PASSANT_KEYS[8];   // En passant file
+	// Generated at compile time from ZOBRIST_SEED by a constexpr PRNG
+	extern const std::array<std::array<std::array<uint64_t, 64>, 6>, 2> PIECE_KEYS; // Piece position keys, [color][pieceType][square]
+	extern const uint64_t SIDE_TO_MOVE_KEY;                                         // Side to move key
+	extern const std::array<uint64_t, 16> CASTLING_KEYS;                            // Castling rights
+	extern const std::array<uint64_t, 8> EN_PASSANT_KEYS;                           // En passant file
+
+	// Cuckoo hash table of reversible moves for upcoming repetition detection
+	// Key is the Zobrist delta of a non-pawn piece moving between two squares (side to move included)
+	// Both directions of a move share one slot, the move is stored as from | to << 6 with from < to
+	extern const std::array<uint64_t, CUCKOO_SIZE> CUCKOO_KEYS;
+	extern const std::array<uint16_t, CUCKOO_SIZE> CUCKOO_MOVES;
+
+	// The two candidate slots of a key
+	constexpr int cuckooSlot1(uint64_t key) { return key & (CUCKOO_SIZE - 1); }
+	constexpr int cuckooSlot2(uint64_t key) { return (key >> 16) & (CUCKOO_SIZE - 1); }
 
-	// Generate all precomputed tables 
+	// Allocate the transposition table and compute the late move reductions
+	// Every other table above is generated at compile time
 	extern std::atomic<bool> initialized; // Track re-initialization need
 	void initTables();
 
@@ -0,0 +1,54 @@
+#ifndef TIMEMANAGER_H
+#define TIMEMANAGER_H
+
+#include "BitboardConstants.hpp"
+#include "CustomTypes.hpp"
+
+/*
+The TimeManager turns the clock state of a search into two limits:
+
+soft limit -> checked between iterations, no new iteration is started after it
+              scaled down when the best move is stable, scaled up when the score drops
+hard limit -> checked inside the search, the running iteration is aborted after it
+
+Depth-only searches have no limits and always run to the requested depth.
+*/
+
+class TimeManager {
+private:
+    std::chrono::steady_clock::time_point start_time;
+
+    int64_t soft_limit; // Milliseconds
+    int64_t hard_limit; // Milliseconds
+    bool timed; // False for depth-only searches
+
+    // Data of the previous completed iteration
+    uint32_t previous_best_move;
+    int previous_score;
+    int stable_iterations; // How many iterations in a row returned the same best move
+    float score_drop_scale; // Soft limit extension after a score drop
+
+public:
+    TimeManager();
+
+    // Start the clock and allocate the limits for this move
+    void start(const SearchLimits& limits);
+
+    // Milliseconds since start()
+    int64_t elapsed() const;
+
+    // Whether the search runs on a clock at all
+    bool isTimed() const;
+
+    // Checked from inside the search, aborts the running iteration
+    bool hardLimitReached() const;
+
+    // Feed the result of a completed iteration
+    // Tracks best move stability and score drops
+    void updateIteration(uint32_t best_move, int score);
+
+    // Checked between iterations, decides if we can afford another one
+    bool softLimitReached() const;
+};
+
+#endif // TIMEMANAGER_H
@@ -30,15 +30,24 @@ namespace Utils {
         #endif
     }
 
-    static inline int getFile(int square) {
+    // Helper to reverse the byte order of a bitboard, mirrors the ranks
+    static inline uint64_t byteSwap(uint64_t bitboard) {
+        #if defined(_MSC_VER) // MSVC
+            return _byteswap_uint64(bitboard);
+        #else // GCC and Clang
+            return __builtin_bswap64(bitboard);
+        #endif
+    }
+
+    static constexpr inline int getFile(int square) {
         return square & 7;
     }
 
-    static inline int getRank(int square) {
+    static constexpr inline int getRank(int square) {
         return square >> 3;
     }
 
-    static inline int getSquare(uint64_t rank, uint64_t file) {
+    static constexpr inline int getSquare(uint64_t rank, uint64_t file) {
         return static_cast<int>(8 * rank + file);
     }
 
@@ -52,6 +61,12 @@ namespace Utils {
 
     static inline void popBit(uint64_t& bn, int sq) { bn &= ~(1ULL << sq); }
 
+    // Shift every square of a bitboard by a direction offset, squares shifted off the board are lost
+    // Wrapping over the a/h-files has to be masked by the caller
+    static inline uint64_t shift(uint64_t bitboard, int offset) {
+        return offset > 0 ? bitboard << offset : bitboard >> -offset;
+    }
+
     static inline int bitScanForward(uint64_t bb) {
         static const int index64[64] = {
             0, 47, 1, 56, 48, 27, 2, 60,
@@ -20,7 +20,9 @@
 #include <cassert>
 #include <chrono>
 #include <random>
+#include <cmath>
 #include <unordered_map>
 #include <atomic>
+#include <thread>
 
 #endif //PCH_H
\ No newline at end of file
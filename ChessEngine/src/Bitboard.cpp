@@ -9,65 +9,69 @@
 
 
 Bitboard::Bitboard():
-	castling_rights(0x0F),                 // All castling rights (0b00001111)
-	en_passant_target(UNASSIGNED),         // None
-	half_moves(0),                         // Initially 0
-	hash_key(0)                           
+	pos(),                                 // Zeroed, filled by initBoard
+	search_stack(nullptr),                 // Given by the search
+	search_ply(0),
+	copy_make(false)
 {
+	pos.castling_rights = 0x0F;            // All castling rights (0b00001111)
+	pos.en_passant_target = UNASSIGNED;    // None
+	pos.half_moves = 0;                    // Initially 0
+	pos.ply_count = 0;                     // Game starts at ply 0
 	initBoard();
 }
 
 void Bitboard::initBoard() {
 	// Standard little-endian rank-file mapping (LSB = a1, MSB = h8)
-	piece_bitboards[WHITE][PAWN] = 0x000000000000FF00;  // a2-h2
-	piece_bitboards[BLACK][PAWN] = 0x00FF000000000000;  // a7-h7
-	piece_bitboards[WHITE][ROOK] = 0x0000000000000081;  // a1, h1
-	piece_bitboards[BLACK][ROOK] = 0x8100000000000000;  // a8, h8
-	piece_bitboards[WHITE][KNIGHT] = 0x0000000000000042;  // b1, g1
-	piece_bitboards[BLACK][KNIGHT] = 0x4200000000000000;  // b8, g8
-	piece_bitboards[WHITE][BISHOP] = 0x0000000000000024;  // c1, f1
-	piece_bitboards[BLACK][BISHOP] = 0x2400000000000000;  // c8, f8
-	piece_bitboards[WHITE][QUEEN] = 0x0000000000000008;  // d1
-	piece_bitboards[BLACK][QUEEN] = 0x0800000000000000;  // d8
-	piece_bitboards[WHITE][KING] = 0x0000000000000010;  // e1
-	piece_bitboards[BLACK][KING] = 0x1000000000000000;  // e8
+	pos.piece_bitboards[WHITE][PAWN] = 0x000000000000FF00;  // a2-h2
+	pos.piece_bitboards[BLACK][PAWN] = 0x00FF000000000000;  // a7-h7
+	pos.piece_bitboards[WHITE][ROOK] = 0x0000000000000081;  // a1, h1
+	pos.piece_bitboards[BLACK][ROOK] = 0x8100000000000000;  // a8, h8
+	pos.piece_bitboards[WHITE][KNIGHT] = 0x0000000000000042;  // b1, g1
+	pos.piece_bitboards[BLACK][KNIGHT] = 0x4200000000000000;  // b8, g8
+	pos.piece_bitboards[WHITE][BISHOP] = 0x0000000000000024;  // c1, f1
+	pos.piece_bitboards[BLACK][BISHOP] = 0x2400000000000000;  // c8, f8
+	pos.piece_bitboards[WHITE][QUEEN] = 0x0000000000000008;  // d1
+	pos.piece_bitboards[BLACK][QUEEN] = 0x0800000000000000;  // d8
+	pos.piece_bitboards[WHITE][KING] = 0x0000000000000010;  // e1
+	pos.piece_bitboards[BLACK][KING] = 0x1000000000000000;  // e8
+
+	// Occupancy follows the piece bitboards incrementally from here on
+	pos.color_occupancy[WHITE] = pos.color_occupancy[BLACK] = 0ULL;
+	for (int piece = PAWN; piece <= KING; ++piece) {
+		pos.color_occupancy[WHITE] |= pos.piece_bitboards[WHITE][piece];
+		pos.color_occupancy[BLACK] |= pos.piece_bitboards[BLACK][piece];
+	}
+	pos.occupied_squares = pos.color_occupancy[WHITE] | pos.color_occupancy[BLACK];
 
 	// Initialize the piece_at_square lookup table
-	std::fill(std::begin(piece_at_square), std::end(piece_at_square), EMPTY);
+	std::fill(std::begin(pos.piece_at_square), std::end(pos.piece_at_square), EMPTY);
 	for (int color = BLACK; color <= WHITE; ++color) { // 0 = BLACK, 1 = WHITE
 		for (int piece = PAWN; piece <= KING; ++piece) {
-			uint64_t bitboard = piece_bitboards[color][piece];
+			uint64_t bitboard = pos.piece_bitboards[color][piece];
 			while (bitboard) {
 				int square = Utils::findFirstSetBit(bitboard);  // Get least significant set bit
-				piece_at_square[square] = static_cast<PieceType>(piece);
+				pos.piece_at_square[square] = static_cast<PieceType>(piece);
 				bitboard &= bitboard - 1;  // Clear LSB
 			}
 		}
 	}
 
-	// Initialize pin-data (initially none)
-	for (int i = 0; i < 64; ++i) {
-		pin_data.pin_rays[i] = 0xFFFFFFFFFFFFFFFFULL;
-	}
-
-	// Initialize attack-data
-	attack_data.attack_ray = 0xFFFFFFFFFFFFFFFFULL;
-	attack_data.attack_squares = 0ULL;
+	// Initialize legality data (no pins or checks at the start)
+	pos.blockers_for_king = 0ULL;
+	pos.checkers = 0ULL;
+	pos.attack_squares = 0ULL;
 
 	// Material and positional scores are initially 0 since equal amount of pieces
-	material_score = 0;
-	positional_score = 0;
-	game_phase_score = MAX_GAME_PHASE; // Max game phase == beginning
+	pos.material_score = 0;
+	pos.positional_score = 0;
+	pos.game_phase_score = MAX_GAME_PHASE; // Max game phase == beginning
 
-	state.flags = 0; // Empty game state at beginning (no check, no checkmate, no stalemate)
-
-	// Reserve space for undo-stacks
-	undo_stack.reserve(MAX_SEARCH_DEPTH);
-	search_history.reserve(MAX_SEARCH_DEPTH);
+	pos.state.flags = 0; // Empty game state at beginning (no check, no checkmate, no stalemate)
 
 	// Compute initial Zobrist key which we update incrementally onwards
-	hash_key = computeZobristHash();
-	position_history[hash_key]++; // Save initial state
+	pos.hash_key = computeZobristHash();
+	key_history[0] = pos.hash_key; // Save initial state
 }
 
 uint64_t Bitboard::computeZobristHash() {
@@ -76,7 +80,7 @@ uint64_t Bitboard::computeZobristHash() {
 	// XOR piece keys
 	for (int color = BLACK; color <= WHITE; ++color) {
 		for (int piece = PAWN; piece <= KING; ++piece) {
-			uint64_t bitboard = piece_bitboards[color][piece];
+			uint64_t bitboard = pos.piece_bitboards[color][piece];
 			while (bitboard) {
 				int square = Utils::findFirstSetBit(bitboard);  // Get least significant set bit
 				hash ^= Tables::PIECE_KEYS[color][piece][square];
@@ -86,7 +90,7 @@ uint64_t Bitboard::computeZobristHash() {
 	}
 
 	// XOR castling rights
-	hash ^= Tables::CASTLING_KEYS[castling_rights];
+	hash ^= Tables::CASTLING_KEYS[pos.castling_rights];
 
 	// No need to XOR EN_PASSANT_KEY since no en passant target initially
 	// No need to XOR SIDE_TO_MOVE_KEY since White starts
@@ -97,34 +101,34 @@ uint64_t Bitboard::computeZobristHash() {
 char Bitboard::getPieceTypeChar(int square_int) const {
 	uint64_t square = 1ULL << square_int; // Cast to bitboard
 
-	if (piece_bitboards[WHITE][PAWN] & square) return 'P';
-	if (piece_bitboards[BLACK][PAWN] & square) return 'p';
-	if (piece_bitboards[WHITE][KNIGHT] & square) return 'N';
-	if (piece_bitboards[BLACK][KNIGHT] & square) return 'n';
-	if (piece_bitboards[WHITE][BISHOP] & square) return 'B';
-	if (piece_bitboards[BLACK][BISHOP] & square) return 'b';
-	if (piece_bitboards[WHITE][ROOK] & square) return 'R';
-	if (piece_bitboards[BLACK][ROOK] & square) return 'r';
-	if (piece_bitboards[WHITE][QUEEN] & square) return 'Q';
-	if (piece_bitboards[BLACK][QUEEN] & square) return 'q';
-	if (piece_bitboards[WHITE][KING] & square) return 'K';
-	if (piece_bitboards[BLACK][KING] & square) return 'k';
+	if (pos.piece_bitboards[WHITE][PAWN] & square) return 'P';
+	if (pos.piece_bitboards[BLACK][PAWN] & square) return 'p';
+	if (pos.piece_bitboards[WHITE][KNIGHT] & square) return 'N';
+	if (pos.piece_bitboards[BLACK][KNIGHT] & square) return 'n';
+	if (pos.piece_bitboards[WHITE][BISHOP] & square) return 'B';
+	if (pos.piece_bitboards[BLACK][BISHOP] & square) return 'b';
+	if (pos.piece_bitboards[WHITE][ROOK] & square) return 'R';
+	if (pos.piece_bitboards[BLACK][ROOK] & square) return 'r';
+	if (pos.piece_bitboards[WHITE][QUEEN] & square) return 'Q';
+	if (pos.piece_bitboards[BLACK][QUEEN] & square) return 'q';
+	if (pos.piece_bitboards[WHITE][KING] & square) return 'K';
+	if (pos.piece_bitboards[BLACK][KING] & square) return 'k';
 	return '\0'; // Empty square
 }
 
 std::string Bitboard::getCastlingRightsString() const {
 	std::string rights;
-	if (castling_rights & 0x01) rights += 'K'; // White kingside
-	if (castling_rights & 0x02) rights += 'Q'; // White queenside
-	if (castling_rights & 0x04) rights += 'k'; // Black kingside
-	if (castling_rights & 0x08) rights += 'q'; // Black queenside
+	if (pos.castling_rights & 0x01) rights += 'K'; // White kingside
+	if (pos.castling_rights & 0x02) rights += 'Q'; // White queenside
+	if (pos.castling_rights & 0x04) rights += 'k'; // Black kingside
+	if (pos.castling_rights & 0x08) rights += 'q'; // Black queenside
 	return rights.empty() ? "-" : rights;
 }
 
 std::string Bitboard::getEnPassantString() const {
 	std::string square;
-	if (en_passant_target != UNASSIGNED) {
-		square = squareToString(en_passant_target); // Transform to algebraic notation
+	if (pos.en_passant_target != UNASSIGNED) {
+		square = squareToString(pos.en_passant_target); // Transform to algebraic notation
 	}
 	else {
 		square = "-"; // Represent as dash if none
@@ -134,16 +138,16 @@ std::string Bitboard::getEnPassantString() const {
 
 std::string Bitboard::getGameState(bool white) {
 	std::string game_state;
-	if (white ? state.isCheckmateWhite() : state.isCheckmateBlack()) {
+	if (white ? pos.state.isCheckmateWhite() : pos.state.isCheckmateBlack()) {
 		game_state = "M";
 	}
-	else if (white ? state.isCheckWhite() : state.isCheckBlack()) {
+	else if (white ? pos.state.isCheckWhite() : pos.state.isCheckBlack()) {
 		game_state = "C";
 	}
-	else if (state.isStalemate()) {
+	else if (pos.state.isStalemate()) {
 		game_state = "S";
 	}
-	else if (state.isDraw()) {
+	else if (pos.state.isDraw()) {
 		game_state = "D";
 	}
 	else {
@@ -159,11 +163,11 @@ std::string Bitboard::squareToString(int square) const {
 }
 
 bool Bitboard::isCheckmate(bool white) {
-	if (!(white ? state.isCheckWhite() : state.isCheckBlack())) {
+	if (!(white ? pos.state.isCheckWhite() : pos.state.isCheckBlack())) {
 		return false; // Not in check, so not checkmate
 
 	}
-	uint64_t king_bitboard = white ? piece_bitboards[WHITE][KING] : piece_bitboards[BLACK][KING];
+	uint64_t king_bitboard = white ? pos.piece_bitboards[WHITE][KING] : pos.piece_bitboards[BLACK][KING];
 	int king_square = Utils::findFirstSetBit(king_bitboard);
 
 	// Get currently possible king moves
@@ -177,30 +181,31 @@ bool Bitboard::isCheckmate(bool white) {
 }
 
 bool Bitboard::isStalemate(bool white) {
-	// Loop over each friendly piece and check if there are legal moves
 	// If none of the pieces have legal moves, results in stalemate
-	uint64_t white_pieces = whitePieces();
-	uint64_t black_pieces = blackPieces();
-	uint64_t friendly = white ? white_pieces : black_pieces;
-	uint64_t possible_moves = 0ULL;
+	return !hasLegalMoves(white);
+}
+
+bool Bitboard::hasLegalMoves(bool white) {
+	// The king first, it's the piece most likely to move when in check
+	int king_square = Utils::findFirstSetBit(pos.piece_bitboards[white][KING]);
+	if (getLegalMoves(king_square, white)) return true;
+
+	// Loop over the other friendly pieces until one of them can move
+	uint64_t friendly = (white ? whitePieces() : blackPieces()) & ~pos.piece_bitboards[white][KING];
 	while (friendly) {
 		int current_square = Utils::findFirstSetBit(friendly); // Isolate LSB and get as index
 		Utils::popBit(friendly, current_square); // Remove the processed square
-		// Get moves 
-		possible_moves = getLegalMoves(current_square, white);
-
-		// Check if any moves
-		if (possible_moves) return false;
+		if (getLegalMoves(current_square, white)) return true;
 	}
-	return true;
+	return false;
 }
 
 int Bitboard::getHalfMoveClock() const {
-	return half_moves;
+	return pos.half_moves;
 }
 
 uint64_t Bitboard::getLegalMoves(int from, bool white) {
-	PieceType piece = piece_at_square[from]; // Get piece type at square
+	PieceType piece = pos.piece_at_square[from]; // Get piece type at square
 
 	// Get both pieces as bitboards
 	uint64_t white_pieces = whitePieces();
@@ -209,7 +214,7 @@ uint64_t Bitboard::getLegalMoves(int from, bool white) {
 	uint64_t legal_moves = 0ULL;
 	// Pawns are handled separately
 	if (piece == PAWN) {
-		legal_moves = Moves::getPawnMoves(from, white_pieces, black_pieces, white, en_passant_target);
+		legal_moves = Moves::getPawnMoves(from, white_pieces, black_pieces, white, pos.en_passant_target);
 	}
 	else {
 		legal_moves = Moves::getPseudoLegalMoves(from, piece, white_pieces | black_pieces);
@@ -217,12 +222,12 @@ uint64_t Bitboard::getLegalMoves(int from, bool white) {
 		legal_moves &= ~(white ? white_pieces : black_pieces);
 	}
 
-	uint64_t enemy_king = white ? piece_bitboards[BLACK][KING] : piece_bitboards[WHITE][KING]; // Get enemy king
+	uint64_t enemy_king = white ? pos.piece_bitboards[BLACK][KING] : pos.piece_bitboards[WHITE][KING]; // Get enemy king
 
 	// Filter king moves
 	if (piece == KING) {
 		// First check ability to castle
-		bool castling_available = (castling_rights & (white ? 0x03 : 0x0C)) != 0 &&
+		bool castling_available = (pos.castling_rights & (white ? 0x03 : 0x0C)) != 0 &&
 			(white ? (from == 4) : (from == 60));
 		// Add if possible
 		if (castling_available) {
@@ -233,20 +238,20 @@ uint64_t Bitboard::getLegalMoves(int from, bool white) {
 		// Includes squares attacked by enemy and enemy kings control squares
 		int enemy_king_sq = Utils::findFirstSetBit(enemy_king);
 		uint64_t enemy_king_control = Moves::getKingMoves(enemy_king_sq); // Get enemy king control
-		uint64_t enemy_control = attack_data.attack_squares | enemy_king_control; // Combine with attack squares
+		uint64_t enemy_control = pos.attack_squares | enemy_king_control; // Combine with attack squares
 
 		// King cannot move onto any of the squares attacked by enemy
-		legal_moves &= ~attack_data.attack_squares;
+		legal_moves &= ~pos.attack_squares;
 	}
 	else {
 		uint64_t piece_bb = 1ULL << from;
 		// If a piece is pinned it can only move along its pin ray
-		if (pin_data.pinned & piece_bb) {
-			legal_moves &= pin_data.pin_rays[from];
+		if (pos.blockers_for_king & piece_bb) {
+			legal_moves &= Tables::LINE[Utils::findFirstSetBit(pos.piece_bitboards[white][KING])][from];
 		}
 		// If there is a current attacker to king, the ray must be blocked, 
 		// meaning only allowed to move to squares along it
-		legal_moves &= attack_data.attack_ray; // Attack ray is only ones if none, so no need for checking
+		legal_moves &= checkMask(white); // Check mask is only ones if not in check, so no need for checking
 	}
 	// Exclude enemy king from moves
 	legal_moves &= ~enemy_king;
@@ -256,51 +261,51 @@ uint64_t Bitboard::getLegalMoves(int from, bool white) {
 
 uint32_t Bitboard::applyMove(int source, int target, PieceType promotion, bool white) {
 	// Get piece types at squares
-	PieceType source_piece = piece_at_square[source];
-	PieceType target_piece = piece_at_square[target];
+	PieceType source_piece = pos.piece_at_square[source];
+	PieceType target_piece = pos.piece_at_square[target];
 	MoveType move_type = getMoveType(source, target, source_piece, target_piece, white);
 
 	// Clear the source square
-	piece_bitboards[white][source_piece] &= ~(1ULL << source);
-	piece_at_square[source] = EMPTY;
-	hash_key ^= Tables::PIECE_KEYS[white][source_piece][source]; 
+	removePiece(white, source_piece, 1ULL << source);
+	pos.piece_at_square[source] = EMPTY;
+	pos.hash_key ^= Tables::PIECE_KEYS[white][source_piece][source]; 
 
 	// Precompute whether castling is affected
-	bool castling_affected = (castling_rights & (white ? 0x03 : 0x0C)) != 0;
-	hash_key ^= Tables::CASTLING_KEYS[castling_rights]; // Clear old castling rights from hash
+	bool castling_affected = (pos.castling_rights & (white ? 0x03 : 0x0C)) != 0;
+	pos.hash_key ^= Tables::CASTLING_KEYS[pos.castling_rights]; // Clear old castling rights from hash
 
 	// If a rook or knight moved, update castling rights
 	if (castling_affected && (source_piece == ROOK || source_piece == KING)) {
 		if (source_piece == ROOK) updateRookCastling(white, source);
-		else if (source_piece == KING) castling_rights &= ~(white ? 0x03 : 0x0C);  // Disable castling rights
+		else if (source_piece == KING) pos.castling_rights &= ~(white ? 0x03 : 0x0C);  // Disable castling rights
 	}
 
 	// If capture, clear target square and update scores
 	if (move_type == CAPTURE || move_type == PROMOTION_CAPTURE) {
-		piece_bitboards[!white][target_piece] &= ~(1ULL << target);
-		hash_key ^= Tables::PIECE_KEYS[!white][target_piece][target];
+		removePiece(!white, target_piece, 1ULL << target);
+		pos.hash_key ^= Tables::PIECE_KEYS[!white][target_piece][target];
 
 		// Update game phase
-		if (target_piece == QUEEN) game_phase_score -= 4;
+		if (target_piece == QUEEN) pos.game_phase_score -= 4;
 		else if (target_piece == ROOK) {
-			if ((castling_rights & (white ? 0x0C : 0x03)) != 0) updateRookCastling(!white, target); // Update castling
-			game_phase_score -= 2;
+			if ((pos.castling_rights & (white ? 0x0C : 0x03)) != 0) updateRookCastling(!white, target); // Update castling
+			pos.game_phase_score -= 2;
 		}
-		else if (target_piece == KNIGHT || target_piece == BISHOP) game_phase_score -= 1;
+		else if (target_piece == KNIGHT || target_piece == BISHOP) pos.game_phase_score -= 1;
 
 		// Update material score
-		material_score += white ? PIECE_VALUES[target_piece] : -PIECE_VALUES[target_piece];
+		pos.material_score += white ? PIECE_VALUES[target_piece] : -PIECE_VALUES[target_piece];
 	}
 
 	// En passant
 	if (move_type == EN_PASSANT) {
 		// Compute the pawn captured by en passant
 		int en_passant_square = white ? (target - 8) : (target + 8);
-		piece_bitboards[!white][PAWN] &= ~(1ULL << en_passant_square); // Capture pawn
-		piece_at_square[en_passant_square] = EMPTY;
-		hash_key ^= Tables::PIECE_KEYS[!white][PAWN][en_passant_square];
+		removePiece(!white, PAWN, 1ULL << en_passant_square); // Capture pawn
+		pos.piece_at_square[en_passant_square] = EMPTY;
+		pos.hash_key ^= Tables::PIECE_KEYS[!white][PAWN][en_passant_square];
 
-		material_score += white ? PIECE_VALUES[PAWN] : -PIECE_VALUES[PAWN];
+		pos.material_score += white ? PIECE_VALUES[PAWN] : -PIECE_VALUES[PAWN];
 	}
 
 	// Castling
@@ -315,124 +320,130 @@ uint32_t Bitboard::applyMove(int source, int target, PieceType promotion, bool w
 		int rook_target = white ? (kingside ? 5 : 3) : (kingside ? 61 : 59);
 
 		// Update hash
-		hash_key ^= Tables::PIECE_KEYS[white][ROOK][rook_origin]; // Clear origin
-		hash_key ^= Tables::PIECE_KEYS[white][ROOK][rook_target]; // Set target
+		pos.hash_key ^= Tables::PIECE_KEYS[white][ROOK][rook_origin]; // Clear origin
+		pos.hash_key ^= Tables::PIECE_KEYS[white][ROOK][rook_target]; // Set target
 	}
 
 	// Promotion
 	if (move_type == PROMOTION || move_type == PROMOTION_CAPTURE) {
 		// Update promoted pieces bitboard
-		piece_bitboards[white][promotion] |= (1ULL << target);
-		piece_at_square[target] = promotion;
-		hash_key ^= Tables::PIECE_KEYS[white][promotion][target];
+		placePiece(white, promotion, 1ULL << target);
+		pos.piece_at_square[target] = promotion;
+		pos.hash_key ^= Tables::PIECE_KEYS[white][promotion][target];
 
 		// Update board state
-		material_score += white ? PIECE_VALUES[promotion] : -PIECE_VALUES[promotion];
-		material_score += white ? -PIECE_VALUES[PAWN] : PIECE_VALUES[PAWN];
+		pos.material_score += white ? PIECE_VALUES[promotion] : -PIECE_VALUES[promotion];
+		pos.material_score += white ? -PIECE_VALUES[PAWN] : PIECE_VALUES[PAWN];
 	}
 	else { // For the non promotion moves move source piece to target
-		piece_bitboards[white][source_piece] |= (1ULL << target);
-		piece_at_square[target] = source_piece;
-		hash_key ^= Tables::PIECE_KEYS[white][source_piece][target];
+		placePiece(white, source_piece, 1ULL << target);
+		pos.piece_at_square[target] = source_piece;
+		pos.hash_key ^= Tables::PIECE_KEYS[white][source_piece][target];
 	}
 
 	// Clear previous en passant if available
-	if (en_passant_target != UNASSIGNED) {
-		hash_key ^= Tables::EN_PASSANT_KEYS[en_passant_target % 8];
+	if (pos.en_passant_target != UNASSIGNED) {
+		pos.hash_key ^= Tables::EN_PASSANT_KEYS[pos.en_passant_target % 8];
 	}
 
 	// Set new castling rights
-	hash_key ^= Tables::CASTLING_KEYS[castling_rights];
+	pos.hash_key ^= Tables::CASTLING_KEYS[pos.castling_rights];
 
 	// Set en passant target if a pawn double pushes
 	if (move_type == PAWN_DOUBLE_PUSH) {
-		en_passant_target = white ? (source + 8) : (target + 8);
-		hash_key ^= Tables::EN_PASSANT_KEYS[target % 8]; // Set new en passant file
+		pos.en_passant_target = white ? (source + 8) : (target + 8);
+		pos.hash_key ^= Tables::EN_PASSANT_KEYS[target % 8]; // Set new en passant file
 	}
 	else {
-		en_passant_target = UNASSIGNED; // Reset en passant
+		pos.en_passant_target = UNASSIGNED; // Reset en passant
 	}
 
 	// Toggle side-to-move key
-	hash_key ^= Tables::SIDE_TO_MOVE_KEY;
+	pos.hash_key ^= Tables::SIDE_TO_MOVE_KEY;
+
+	assert(isOccupancyConsistent());
 
 	// Get new board state
 	updateBoardState(white);
+	updateGameOverState(white);
 	updatePositionalScore();
 
+	// Increase ply count and save the new state to the key history
+	pos.ply_count++;
+	key_history[pos.ply_count & KEY_HISTORY_MASK] = pos.hash_key;
+
 	// For reversible moves increment half-moves
-	// Position history saved for also irreversible moves, but cleared before applying
+	// Irreversible moves end the part of the key history a repetition can reach
 	// If reversable, check for draw by repetition
 	if (!(source_piece == PAWN || move_type == CAPTURE || move_type == CASTLING)) {
-		half_moves++;
-		position_history[hash_key]++; // Save new state
+		pos.half_moves++;
 		updateDrawByRepetition();
 	}
 	else {
-		half_moves = 0; // Reset half-moves if irreversible
-		position_history.clear(); // Reset threefold tracking
-		position_history[hash_key]++; // Save new state
+		pos.half_moves = 0; // Reset half-moves if irreversible
 	}
 
-	// Increase ply count
-	ply_count++;
-
 	// Finally return the encoded move
 	return ChessAI::encodeMove(source, target, source_piece, target_piece, move_type, promotion, false); // Don't add check flag
 }
 
 bool Bitboard::isEndgame() {
 	// Condition 1: No queens or only one side has a queen
-	int queens = Utils::countSetBits(piece_bitboards[WHITE][QUEEN]) + Utils::countSetBits(piece_bitboards[BLACK][QUEEN]);
+	int queens = Utils::countSetBits(pos.piece_bitboards[WHITE][QUEEN]) + Utils::countSetBits(pos.piece_bitboards[BLACK][QUEEN]);
 	if (queens <= 1) return true;
 
 	// Condition 2: Few total non-pawn pieces (e.g., 4 or fewer)
-	int total = Utils::countSetBits(whitePieces() | blackPieces());
-	int pawns = Utils::countSetBits(piece_bitboards[WHITE][PAWN]) + Utils::countSetBits(piece_bitboards[BLACK][PAWN]);
+	int total = Utils::countSetBits(occupiedSquares());
+	int pawns = Utils::countSetBits(pos.piece_bitboards[WHITE][PAWN]) + Utils::countSetBits(pos.piece_bitboards[BLACK][PAWN]);
 	if (total - pawns <= 4) return true;
 
 	// Condition 3: Only pawns + kings remain
-	int kings = Utils::countSetBits(piece_bitboards[WHITE][KING]) + Utils::countSetBits(piece_bitboards[BLACK][KING]);
+	int kings = Utils::countSetBits(pos.piece_bitboards[WHITE][KING]) + Utils::countSetBits(pos.piece_bitboards[BLACK][KING]);
 	if (total == kings + pawns) return true;
 
 	return false; // No conditions filled
 }
 
 void Bitboard::updateDrawByRepetition() {
-	if (position_history[hash_key] >= 3) {
-		state.flags |= BoardState::DRAW_REPETITION;
+	if (isDrawByRepetition()) {
+		pos.state.flags |= BoardState::DRAW_REPETITION;
 	}
-	else if (half_moves >= 50) {
-		state.flags |= BoardState::DRAW_50;
+	else if (pos.half_moves >= 50) {
+		pos.state.flags |= BoardState::DRAW_50;
 	}
 }
 
-int Bitboard::getPlyCount() const {
-	return ply_count;
+void Bitboard::updateGameOver(bool white) {
+	updateGameOverState(white);
 }
 
-uint64_t Bitboard::whitePieces() {
-	return piece_bitboards[WHITE][PAWN] | piece_bitboards[WHITE][ROOK] | piece_bitboards[WHITE][KNIGHT] |
-		piece_bitboards[WHITE][BISHOP] | piece_bitboards[WHITE][QUEEN] | piece_bitboards[WHITE][KING];
+int Bitboard::getPlyCount() const {
+	return pos.ply_count;
 }
 
-uint64_t Bitboard::blackPieces() {
-	return piece_bitboards[BLACK][PAWN] | piece_bitboards[BLACK][ROOK] | piece_bitboards[BLACK][KNIGHT] |
-		piece_bitboards[BLACK][BISHOP] | piece_bitboards[BLACK][QUEEN] | piece_bitboards[BLACK][KING];
+bool Bitboard::isOccupancyConsistent() const {
+	uint64_t white_pieces = 0ULL;
+	uint64_t black_pieces = 0ULL;
+	for (int piece = PAWN; piece <= KING; ++piece) {
+		white_pieces |= pos.piece_bitboards[WHITE][piece];
+		black_pieces |= pos.piece_bitboards[BLACK][piece];
+	}
+	return white_pieces == pos.color_occupancy[WHITE] && black_pieces == pos.color_occupancy[BLACK] &&
+		(white_pieces | black_pieces) == pos.occupied_squares && !(white_pieces & black_pieces);
 }
 
 uint64_t Bitboard::getCastlingMoves(bool white) {
 	// Initialize castling moves
 	uint64_t castling_moves = 0ULL;
-	uint64_t occupied = whitePieces() | blackPieces();
+	uint64_t occupied = occupiedSquares();
 
 	// If is in check, cannot castle
-	if (white ? state.isCheckWhite() : state.isCheckBlack()) return 0ULL;
+	if (white ? pos.state.isCheckWhite() : pos.state.isCheckBlack()) return 0ULL;
 
 	uint64_t critical_squares;
 	// Depending on player turn and castling availability add available castling moves
 	if (white) {
-		if (castling_rights & 0x01) { // White Kingside
+		if (pos.castling_rights & 0x01) { // White Kingside
 			if ((occupied & WHITE_KINGSIDE_CASTLE_SQUARES) == 0) { // f1 and g1 must be free
 				// King cannot castle out of, through, or into check
 				// Get squares that can't be under attack
@@ -441,33 +452,33 @@ uint64_t Bitboard::getCastlingMoves(bool white) {
 				// Now compare with opponents attack squares and make sure no squares align (bitwise AND)
 				// // Ensure the king does not move through or into check
 				// If castling available, add to moves
-				if (!(critical_squares & attack_data.attack_squares)) {
+				if (!(critical_squares & pos.attack_squares)) {
 					castling_moves |= 1ULL << 6; // King moves to g1
 				}
 			}
 		}
-		if (castling_rights & 0x02) { // White Queenside
+		if (pos.castling_rights & 0x02) { // White Queenside
 			if ((occupied & WHITE_QUEENSIDE_CASTLE_SQUARES) == 0) { // b1, c1 and d1 must be free
 				critical_squares = WHITE_QUEENSIDE_CASTLE_SQUARES;
-				if (!(critical_squares & attack_data.attack_squares)) {
+				if (!(critical_squares & pos.attack_squares)) {
 					castling_moves |= 1ULL << 2; // King moves to c1
 				}
 			}
 		}
 	}
 	else {
-		if (castling_rights & 0x04) { // Black Kingside
+		if (pos.castling_rights & 0x04) { // Black Kingside
 			if ((occupied & BLACK_KINGSIDE_CASTLE_SQUARES) == 0) { // f8 and g8 must be free
 				critical_squares = BLACK_KINGSIDE_CASTLE_SQUARES; // e8, f8, g8
-				if (!(critical_squares & attack_data.attack_squares)) {
+				if (!(critical_squares & pos.attack_squares)) {
 					castling_moves |= 1ULL << 62; // King moves to g8
 				}
 			}
 		}
-		if (castling_rights & 0x08) { // Black Queenside
+		if (pos.castling_rights & 0x08) { // Black Queenside
 			if ((occupied & BLACK_QUEENSIDE_CASTLE_SQUARES) == 0) { // c8 and d8 must be free
 				critical_squares = BLACK_QUEENSIDE_CASTLE_SQUARES; // e8, d8, c8
-				if (!(critical_squares & attack_data.attack_squares)) {
+				if (!(critical_squares & pos.attack_squares)) {
 					castling_moves |= 1ULL << 58; // King moves to c8
 				}
 			}
@@ -478,100 +489,97 @@ uint64_t Bitboard::getCastlingMoves(bool white) {
 }
 
 void Bitboard::updateRookCastling(bool white, int source) {
-	if (white && (castling_rights & 0x01 || castling_rights & 0x02)) {
-		if (source % 8 == 0) { // Queenside
-			castling_rights &= ~0x02;
-		}
-		else if (source % 8 == 7) { // Kingside
-			castling_rights &= ~0x01;
-		}
-	}
-	else if (!white && (castling_rights & 0x04 || castling_rights & 0x08)) {
-		if (source % 8 == 0) { // Queenside
-			castling_rights &= ~0x08;
-		}
-		else if (source % 8 == 7) { // Kingside
-			castling_rights &= ~0x04;
-		}
-	}
+	pos.castling_rights &= ~rookCastlingRight(white, source);
+}
+
+uint8_t Bitboard::rookCastlingRight(bool white, int square) {
+	if (square % 8 == 0) return white ? 0x02 : 0x08; // Queenside
+	if (square % 8 == 7) return white ? 0x01 : 0x04; // Kingside
+	return 0;
 }
 
 void Bitboard::handleCastling(bool white, int target) {
 	if (white) {
 		// White castling: Kingside (h1 -> f1), Queenside (a1 -> d1)
 		if (target == 6) { // Kingside castling (g1)
-			piece_bitboards[WHITE][ROOK] &= ~ROOK_H1; // Remove rook from h1
-			piece_bitboards[WHITE][ROOK] |= ROOK_F1; // Move rook to f1
+			removePiece(WHITE, ROOK, ROOK_H1); // Remove rook from h1
+			placePiece(WHITE, ROOK, ROOK_F1); // Move rook to f1
 
 			// Also update piece types
-			piece_at_square[7] = EMPTY;
-			piece_at_square[5] = ROOK;
+			pos.piece_at_square[7] = EMPTY;
+			pos.piece_at_square[5] = ROOK;
 		}
 		else if (target == 2) { // Queenside castling (c1)
-			piece_bitboards[WHITE][ROOK] &= ~ROOK_A1; // Remove rook from a1
-			piece_bitboards[WHITE][ROOK] |= ROOK_D1; // Move rook to d1
+			removePiece(WHITE, ROOK, ROOK_A1); // Remove rook from a1
+			placePiece(WHITE, ROOK, ROOK_D1); // Move rook to d1
 
-			piece_at_square[0] = EMPTY;
-			piece_at_square[3] = ROOK;
+			pos.piece_at_square[0] = EMPTY;
+			pos.piece_at_square[3] = ROOK;
 		}
 	}
 	else {
 		// Black castling: Kingside (h8 -> f8), Queenside (a8 -> d8)
 		if (target == 62) { // Kingside castling (g8)
-			piece_bitboards[BLACK][ROOK] &= ~ROOK_H8; // Remove rook from h8
-			piece_bitboards[BLACK][ROOK] |= ROOK_F8; // Move rook to f8
+			removePiece(BLACK, ROOK, ROOK_H8); // Remove rook from h8
+			placePiece(BLACK, ROOK, ROOK_F8); // Move rook to f8
 
-			piece_at_square[63] = EMPTY;
-			piece_at_square[61] = ROOK;
+			pos.piece_at_square[63] = EMPTY;
+			pos.piece_at_square[61] = ROOK;
 		}
 		else if (target == 58) { // Queenside castling (c8)
-			piece_bitboards[BLACK][ROOK] &= ~ROOK_A8; // Remove rook from a8
-			piece_bitboards[BLACK][ROOK] |= ROOK_D8; // Move rook to d8
+			removePiece(BLACK, ROOK, ROOK_A8); // Remove rook from a8
+			placePiece(BLACK, ROOK, ROOK_D8); // Move rook to d8
 
-			piece_at_square[56] = EMPTY;
-			piece_at_square[59] = ROOK;
+			pos.piece_at_square[56] = EMPTY;
+			pos.piece_at_square[59] = ROOK;
 		}
 	}
 }
 
 
-void Bitboard::getAttackSquares(int enemy_king, const uint64_t& white_pieces, const uint64_t black_pieces, bool white) {
-	// Reset previous attack squares and ray
-	attack_data.attack_ray = 0xFFFFFFFFFFFFFFFFULL; // Full ray so moves don't get limited
-	attack_data.attack_squares = 0ULL; // None
+void Bitboard::getAttackSquares(uint64_t occupied, bool white) {
+	// Pawn captures of every pawn at once, masking the files they would wrap over
+	uint64_t pawns = pos.piece_bitboards[white][PAWN];
+	pos.attack_squares = white ? ((pawns & ~FILE_A) << 7) | ((pawns & ~FILE_H) << 9)
+		: ((pawns & ~FILE_A) >> 9) | ((pawns & ~FILE_H) >> 7);
 
-	uint64_t occupied = white_pieces | black_pieces;
+	uint64_t knights = pos.piece_bitboards[white][KNIGHT];
+	while (knights) {
+		int current_square = Utils::findFirstSetBit(knights);
+		Utils::popBit(knights, current_square);
+		pos.attack_squares |= Moves::getKnightMoves(current_square);
+	}
 
-	// Get pseudo-legal moves for our pieces
-	// If a move lands on enemy king, update check and the attack ray
-	uint64_t friendly = white ? white_pieces : black_pieces;
-	while (friendly) {
-		int current_square = Utils::findFirstSetBit(friendly);
-		Utils::popBit(friendly, current_square);
-		PieceType piece_type = piece_at_square[current_square];
-		// Get pseudo-legal moves
-		// If pawn get only capture moves since those are the attack squares
-		uint64_t moves;
-		if (piece_type == PAWN) {
-			moves = Moves::getPawnCaptures(current_square, white);
-		}
-		else {
-			moves = Moves::getPseudoLegalMoves(current_square, piece_type, occupied);
-		}
-		// If move landed on enemy king get the pre-computed attack ray
-		if (moves & (1ULL << enemy_king)) {
-			attack_data.attack_ray = Tables::BETWEEN[current_square][enemy_king] | (1ULL << current_square) | (1ULL << enemy_king);
-			// Also update that the king is in check
-			state.flags |= (white ? BoardState::CHECK_BLACK : BoardState::CHECK_WHITE);
-		}
-		attack_data.attack_squares |= moves; // Add to attack data
+	// Queens are added as both a bishop and a rook
+	uint64_t diagonal_sliders = pos.piece_bitboards[white][BISHOP] | pos.piece_bitboards[white][QUEEN];
+	while (diagonal_sliders) {
+		int current_square = Utils::findFirstSetBit(diagonal_sliders);
+		Utils::popBit(diagonal_sliders, current_square);
+		pos.attack_squares |= Moves::getBishopMoves(current_square, occupied);
+	}
+
+	uint64_t orthogonal_sliders = pos.piece_bitboards[white][ROOK] | pos.piece_bitboards[white][QUEEN];
+	while (orthogonal_sliders) {
+		int current_square = Utils::findFirstSetBit(orthogonal_sliders);
+		Utils::popBit(orthogonal_sliders, current_square);
+		pos.attack_squares |= Moves::getRookMoves(current_square, occupied);
 	}
+
+	pos.attack_squares |= Moves::getKingMoves(Utils::findFirstSetBit(pos.piece_bitboards[white][KING]));
+}
+
+uint64_t Bitboard::checkMask(bool white) const {
+	if (!pos.checkers) return 0xFFFFFFFFFFFFFFFFULL; // Full mask so moves don't get limited
+	if (pos.checkers & (pos.checkers - 1)) return 0ULL; // Double check, only the king can move
+
+	int king_square = Utils::findFirstSetBit(pos.piece_bitboards[white][KING]);
+	return Tables::BETWEEN[king_square][Utils::findFirstSetBit(pos.checkers)] | pos.checkers;
 }
 
 bool Bitboard::canBlock(bool white) {
 	// Get own pieces depending on the turn
 	uint64_t friendly = white ? whitePieces() : blackPieces();
-	friendly &= ~piece_bitboards[white][KING]; // Exclude own king
+	friendly &= ~pos.piece_bitboards[white][KING]; // Exclude own king
 
 	// Loop over own pieces and get their possible attacks at the current square
 	// If the move is able to block the attack ray returns true
@@ -579,52 +587,53 @@ bool Bitboard::canBlock(bool white) {
 	while (friendly) {
 		int current_square = Utils::findFirstSetBit(friendly); // Isolate LSB and get as index
 		Utils::popBit(friendly, current_square); // Remove the processed square
-		// Get moves
+		// Get moves, they are already limited to the check mask
 		possible_moves = getLegalMoves(current_square, white);
 
 		// Check for ability to block
-		if (possible_moves & attack_data.attack_ray) return true;
+		if (possible_moves) return true;
 	}
 	return false; // No blocks were found
 }
 
 void Bitboard::updateBoardState(bool white) {
-	state.flags = 0; // Reset state before updating
-	
-	// Calculate pinned enemy pieces
+	pos.state.flags = 0; // Reset state before updating
+
+	// Pins and checks of the side to move, found set-wise from its king square
 	// Used for legal move generation
-	uint64_t white_pieces = whitePieces();
-	uint64_t black_pieces = blackPieces();
+	uint64_t occupied = occupiedSquares();
+	uint64_t enemy_king = pos.piece_bitboards[!white][KING];
+	int king_sq = Utils::findFirstSetBit(enemy_king);
 
-	uint64_t enemy_king = piece_bitboards[!white][KING];
-	int king_bb = Utils::findFirstSetBit(enemy_king);
+	pos.blockers_for_king = Moves::computeKingBlockers(king_sq, occupied,
+		pos.piece_bitboards[white][BISHOP] | pos.piece_bitboards[white][QUEEN], pos.piece_bitboards[white][ROOK] | pos.piece_bitboards[white][QUEEN]);
 
-	Moves::computePinnedPieces(pin_data, king_bb, white_pieces | black_pieces, 
-		piece_bitboards[white][BISHOP], piece_bitboards[white][ROOK], piece_bitboards[white][QUEEN]);
+	pos.checkers = attackersTo(king_sq, occupied) & (white ? whitePieces() : blackPieces());
+	if (pos.checkers) pos.state.flags |= (white ? BoardState::CHECK_BLACK : BoardState::CHECK_WHITE);
 
 	// Now we calculate attack squares of the previously moved side
-	// Exclude enemy king from calculation so we get the rays that pass through king
-	// Also updates if the move got the enemy king in check and calculates the attack ray
-	(white ? black_pieces : white_pieces) &= ~enemy_king;
-	getAttackSquares(king_bb, white_pieces, black_pieces, white);
+	// Exclude enemy king from the occupancy so we get the rays that pass through king
+	getAttackSquares(occupied & ~enemy_king, white);
+}
 
+void Bitboard::updateGameOverState(bool white) {
 	// Check/checkmate/stalemate check
-	if (state.isCheckBlack() || state.isCheckWhite()) {
+	if (pos.state.isCheckBlack() || pos.state.isCheckWhite()) {
 		if (isCheckmate(!white)) { // Only if in check continue to checkmate 
-			state.flags |=  white ? BoardState::CHECKMATE_BLACK : BoardState::CHECKMATE_WHITE;
+			pos.state.flags |=  white ? BoardState::CHECKMATE_BLACK : BoardState::CHECKMATE_WHITE;
 		}
 	}
 	else if (isStalemate(!white)) {
-		state.flags |= BoardState::STALEMATE;
+		pos.state.flags |= BoardState::STALEMATE;
 	}
 }
 
 void Bitboard::updatePositionalScore() {
 	// Reset positional score
-	positional_score = 0;
+	pos.positional_score = 0;
 
 	// Get game phase
-	float game_phase = std::max(0.0f, std::min(1.0f, static_cast<float>(game_phase_score) / MAX_GAME_PHASE));
+	float game_phase = std::max(0.0f, std::min(1.0f, static_cast<float>(pos.game_phase_score) / MAX_GAME_PHASE));
 
 	// Get all pieces of both sides
 	uint64_t white_pieces = whitePieces();
@@ -634,12 +643,12 @@ void Bitboard::updatePositionalScore() {
 	while (white_pieces) {
 		int sq = Utils::findFirstSetBit(white_pieces);
 		Utils::popBit(white_pieces, sq);
-		positional_score += getPositionalScore(sq, game_phase, piece_at_square[sq], true);
+		pos.positional_score += getPositionalScore(sq, game_phase, pos.piece_at_square[sq], true);
 	}
 	while (black_pieces) {
 		int sq = Utils::findFirstSetBit(black_pieces);
 		Utils::popBit(black_pieces, sq);
-		positional_score -= getPositionalScore(sq, game_phase, piece_at_square[sq], false);
+		pos.positional_score -= getPositionalScore(sq, game_phase, pos.piece_at_square[sq], false);
 	}
 }
 
@@ -656,328 +665,443 @@ void Bitboard::updatePositionalScore() {
 * 
 */
 
-void Bitboard::startNewSearch() {
-	// Clear stacks
-	undo_stack.clear();
-	search_history.clear();
+void Bitboard::startNewSearch(SearchStack* stack, bool copy_make_search) {
+	// Entries are overwritten as the search goes, no clearing needed
+	search_stack = stack;
+	search_ply = 0;
+	copy_make = copy_make_search;
+}
 
-	// Also reserve space for all the new potential elements to avoid dynamic resizing (causes overhead)
-	undo_stack.reserve(MAX_SEARCH_DEPTH);
-	search_history.reserve(MAX_SEARCH_DEPTH);
+int Bitboard::getSearchPly() const {
+	return search_ply;
 }
 
 uint64_t Bitboard::getHashKey() {
-	return hash_key;
+	return pos.hash_key;
+}
+
+KingDanger Bitboard::getCheckSquares(bool white) const {
+	int enemy_king = Utils::findFirstSetBit(pos.piece_bitboards[!white][KING]);
+	return Moves::computeKingDanger(enemy_king, occupiedSquares(), white);
 }
 
-void Bitboard::generateMoves(std::array<uint32_t, MAX_MOVES>& move_list, int& move_count, int depth, bool white, uint32_t move_hint) {
-	move_count = 0;
-	std::array<std::pair<uint32_t, int>, MAX_MOVES> move_scores; // Stack allocated array
+uint64_t Bitboard::getDiscoveredCheckers(bool white) const {
+	// Own pieces alone between the enemy king and an own slider
+	int enemy_king = Utils::findFirstSetBit(pos.piece_bitboards[!white][KING]);
+	uint64_t blockers = Moves::computeKingBlockers(enemy_king, occupiedSquares(),
+		pos.piece_bitboards[white][BISHOP] | pos.piece_bitboards[white][QUEEN], pos.piece_bitboards[white][ROOK] | pos.piece_bitboards[white][QUEEN]);
+	return blockers & (white ? whitePieces() : blackPieces());
+}
 
-	// Generate all moves directly into move_scores with scoring
-	uint64_t friendly_pieces = white ? whitePieces() : blackPieces();
-	while (friendly_pieces) {
-		int from = Utils::findFirstSetBit(friendly_pieces);
-		PieceType piece = piece_at_square[from];
-		uint64_t legal_moves = getLegalMoves(from, white);
+bool Bitboard::givesCheck(uint32_t move, const KingDanger& king_danger, uint64_t discovered_checkers, bool white) {
+	int from = ChessAI::from(move);
+	int to = ChessAI::to(move);
+	// Rare, the rook check and the line opened by the captured pawn aren't worth resolving
+	MoveType move_type = ChessAI::moveType(move);
+	if (move_type == CASTLING || move_type == EN_PASSANT) return true;
 
-		while (legal_moves) {
-			int to = Utils::findFirstSetBit(legal_moves);
-			PieceType target_piece = piece_at_square[to];
-			MoveType move_type = getMoveType(from, to, piece, target_piece, white);
+	if (isCheckMove(king_danger, to, ChessAI::piece(move))) return true;
 
-			// Encode move (check moves only handled in endgame)
-			// Promote only to queen
-			uint32_t move = ChessAI::encodeMove(from, to, piece, target_piece, move_type,
-				(move_type == PROMOTION || move_type == PROMOTION_CAPTURE) ? QUEEN : EMPTY, false);
+	// Discovered check if the piece leaves the line between the king and the slider behind it
+	int enemy_king = Utils::findFirstSetBit(pos.piece_bitboards[!white][KING]);
+	return (discovered_checkers & (1ULL << from)) && !(Tables::LINE[enemy_king][from] & (1ULL << to));
+}
 
-			// --- Scoring Logic ---
-			int score = 0; // Default score for quiet moves at depth 0 or unhandled cases
+uint64_t Bitboard::keyAfter(uint32_t move, bool white) const {
+	int source = ChessAI::from(move);
+	int target = ChessAI::to(move);
+	PieceType source_piece = ChessAI::piece(move);
+	PieceType target_piece = ChessAI::capturedPiece(move);
+	MoveType move_type = ChessAI::moveType(move);
 
-			// Check if this is the TT move hint
-			if (move_hint != NULL_MOVE_32 && move == move_hint) {
-				score = TT_MOVE_SCORE;
-			}
-			else {
-				// If not TT move, score captures using MVV-LVA
-				if (move_type == CAPTURE || move_type == PROMOTION_CAPTURE || move_type == EN_PASSANT) {
-					PieceType victim = (move_type == EN_PASSANT) ? PAWN : target_piece;
-					score = MVV_LVA[victim][piece];
-				}
-				else if (depth > 0) { // If non-capture, prioritize killer moves and use history heuristic (not scored for depth 0)
-					// Killer move priority
-					if (ChessAI::isKillerMove(from, to, piece, depth)) {
-						score = KILLER_SCORE;
-					}
-					else {
-						score = ChessAI::getHistoryScore(from, to, piece);
-					}
-
-					// Prioritize queen promotions
-					if (move_type == PROMOTION || move_type == PROMOTION_CAPTURE) score += QUEEN_PROMOTION;
-				}
-			}
+	uint64_t key = pos.hash_key ^ Tables::SIDE_TO_MOVE_KEY;
 
-			move_scores[move_count++] = { move, score };
+	// Moving piece, promoted pawns land as the promotion piece
+	PieceType landing_piece = (move_type == PROMOTION || move_type == PROMOTION_CAPTURE) ? ChessAI::promotion(move) : source_piece;
+	key ^= Tables::PIECE_KEYS[white][source_piece][source] ^ Tables::PIECE_KEYS[white][landing_piece][target];
 
-			Utils::popBit(legal_moves, to);
-		}
-		Utils::popBit(friendly_pieces, from);
+	if (move_type == CAPTURE || move_type == PROMOTION_CAPTURE) {
+		key ^= Tables::PIECE_KEYS[!white][target_piece][target];
+	}
+	else if (move_type == EN_PASSANT) {
+		key ^= Tables::PIECE_KEYS[!white][PAWN][white ? (target - 8) : (target + 8)];
+	}
+	else if (move_type == CASTLING) {
+		bool kingside = target == 6 || target == 62;
+		int rook_origin = white ? (kingside ? 7 : 0) : (kingside ? 63 : 56);
+		int rook_target = white ? (kingside ? 5 : 3) : (kingside ? 61 : 59);
+		key ^= Tables::PIECE_KEYS[white][ROOK][rook_origin] ^ Tables::PIECE_KEYS[white][ROOK][rook_target];
 	}
 
-	// Sort only the portion containing actual moves
-	std::sort(move_scores.begin(), move_scores.begin() + move_count,
-		[](const auto& a, const auto& b) { return a.second > b.second; });
+	// Castling rights lost by the move, same rules as applyMoveAI
+	uint8_t rights = pos.castling_rights;
+	if (source_piece == KING) rights &= white ? ~0x03 : ~0x0C;
+	else if (source_piece == ROOK) rights &= ~rookCastlingRight(white, source);
+	if ((move_type == CAPTURE || move_type == PROMOTION_CAPTURE) && target_piece == ROOK) rights &= ~rookCastlingRight(!white, target);
+	key ^= Tables::CASTLING_KEYS[pos.castling_rights] ^ Tables::CASTLING_KEYS[rights];
 
-	// Extract just the moves
-	for (int i = 0; i < move_count; ++i) {
-		move_list[i] = move_scores[i].first;
-	}
+	// En passant target of the previous move expires, a double push sets a new one
+	if (pos.en_passant_target != UNASSIGNED) key ^= Tables::EN_PASSANT_KEYS[pos.en_passant_target % 8];
+	if (move_type == PAWN_DOUBLE_PUSH) key ^= Tables::EN_PASSANT_KEYS[target % 8];
+
+	return key;
 }
 
-void Bitboard::generateNoisyMoves(std::array<uint32_t, MAX_MOVES>& move_list, int& move_count, bool white) {
-	move_count = 0;
-	std::array<std::pair<uint32_t, int>, MAX_MOVES> move_scores;  // Stack-allocated array
+void Bitboard::generateCaptures(std::array<ScoredMove, MAX_MOVES>& move_list, int& move_count, bool white) {
+	int first = move_count;
+	generateLegalMoves(move_list, move_count, GEN_NOISY, false, white);
 
-	uint64_t friendly_pieces = white ? whitePieces() : blackPieces();
-	uint64_t opponent_pieces = white ? blackPieces() : whitePieces();
+	for (int i = first; i < move_count; i++) {
+		uint32_t move = move_list[i].move;
+		PieceType piece = ChessAI::piece(move);
+		MoveType move_type = ChessAI::moveType(move);
 
-	while (friendly_pieces) {
-		int from = Utils::findFirstSetBit(friendly_pieces);
-		PieceType piece = piece_at_square[from];
-		uint64_t legal_moves = getLegalMoves(from, white);
-		uint64_t captures = legal_moves & opponent_pieces;
+		// Score captures using MVV-LVA, losing captures (SEE) get a negative score
+		int score = 0;
+		if (move_type != PROMOTION) {
+			PieceType victim = (move_type == EN_PASSANT) ? PAWN : ChessAI::capturedPiece(move);
+			score = MVV_LVA[victim][piece];
 
-		// Process captures first
-		while (captures) {
-			int to = Utils::findFirstSetBit(captures);
-			PieceType target_piece = piece_at_square[to];
-			MoveType move_type = getMoveType(from, to, piece, target_piece, white);
+			// Taking an equal or bigger piece can't lose, SEE only needed otherwise
+			if (PIECE_VALUES[piece] > PIECE_VALUES[victim] && staticExchangeEvaluation(move) < 0) {
+				score += BAD_CAPTURE_SCORE;
+			}
+		}
+		if (move_type == PROMOTION || move_type == PROMOTION_CAPTURE) score += QUEEN_PROMOTION;
 
-			// Score moves using MVV-LVA for captures
-			int score = MVV_LVA[target_piece][piece];
+		move_list[i].score = score;
+	}
+}
 
-			move_scores[move_count++] = { ChessAI::encodeMove(from, to, piece, target_piece, move_type,
-				(move_type == PROMOTION_CAPTURE) ? QUEEN : EMPTY, false), score + (move_type == PROMOTION_CAPTURE) ? QUEEN_PROMOTION : 0};
+void Bitboard::generateQuiets(std::array<ScoredMove, MAX_MOVES>& move_list, int& move_count, int depth, bool white) {
+	int first = move_count;
+	generateLegalMoves(move_list, move_count, GEN_QUIET, false, white);
 
-			Utils::popBit(captures, to);
-		}
+	// History heuristic orders the quiet moves (not scored for depth 0)
+	if (depth <= 0) return;
+	for (int i = first; i < move_count; i++) {
+		uint32_t move = move_list[i].move;
+		move_list[i].score = ChessAI::getHistoryScore(ChessAI::from(move), ChessAI::to(move), ChessAI::piece(move));
+	}
+}
 
-		// Process en passant if applicable
-		if (piece == PAWN && en_passant_target != UNASSIGNED) {
-			uint64_t ep_mask = 1ULL << en_passant_target;
-			if (legal_moves & ep_mask) {
-				move_scores[move_count++] = { ChessAI::encodeMove(from, en_passant_target, PAWN, EMPTY, EN_PASSANT, EMPTY, false), MVV_LVA[PAWN][PAWN]};
+void Bitboard::generateLegalMoves(std::array<ScoredMove, MAX_MOVES>& move_list, int& move_count, GenType type, bool underpromotions, bool white) {
+	// Masks of the node, shared by every piece
+	uint64_t enemy_king = pos.piece_bitboards[!white][KING];
+	uint64_t opponent_pieces = (white ? blackPieces() : whitePieces()) & ~enemy_king; // The king is never captured
+	uint64_t occupied = occupiedSquares();
+	uint64_t empty_squares = ~occupied;
+	uint64_t check_mask = checkMask(white); // All ones if not in check
+	int king = Utils::findFirstSetBit(pos.piece_bitboards[white][KING]);
+
+	uint64_t targets = empty_squares | opponent_pieces;
+	if (type == GEN_NOISY) targets = opponent_pieces;
+	else if (type == GEN_QUIET) targets = empty_squares;
+
+	for (PieceType piece : { KNIGHT, BISHOP, ROOK, QUEEN }) {
+		uint64_t pieces = pos.piece_bitboards[white][piece];
+		while (pieces) {
+			int from = Utils::findFirstSetBit(pieces);
+			Utils::popBit(pieces, from);
+
+			uint64_t moves = Moves::getPseudoLegalMoves(from, piece, occupied) & targets & check_mask;
+			if (pos.blockers_for_king & (1ULL << from)) moves &= Tables::LINE[king][from];
+
+			while (moves) {
+				int to = Utils::findFirstSetBit(moves);
+				Utils::popBit(moves, to);
+
+				PieceType target_piece = pos.piece_at_square[to];
+				move_list[move_count++] = { ChessAI::encodeMove(from, to, piece, target_piece,
+					target_piece == EMPTY ? NORMAL : CAPTURE, EMPTY, false), 0 };
 			}
 		}
+	}
 
-		// Process quiet promotions to queen
-		if (piece == PAWN) {
-			uint64_t promotion_mask = (white ? RANK_8 : RANK_1) & ~(opponent_pieces);
-			if ((legal_moves & promotion_mask) != 0) {
-				int promotion_sq = Utils::findFirstSetBit(legal_moves & promotion_mask);
-				move_scores[move_count++] = { ChessAI::encodeMove(from, promotion_sq, PAWN, EMPTY, PROMOTION, QUEEN, false), QUEEN_PROMOTION };
-			}
-		}
+	// Pawns not pinned at once, pinned ones one by one along their pin ray
+	uint64_t pawns = pos.piece_bitboards[white][PAWN];
+	uint64_t pinned_pawns = pawns & pos.blockers_for_king;
+	generatePawnMoves(move_list, move_count, pawns & ~pinned_pawns, check_mask, empty_squares, opponent_pieces, type, underpromotions, white);
+	while (pinned_pawns) {
+		int from = Utils::findFirstSetBit(pinned_pawns);
+		Utils::popBit(pinned_pawns, from);
+		generatePawnMoves(move_list, move_count, 1ULL << from, check_mask & Tables::LINE[king][from], empty_squares, opponent_pieces,
+			type, underpromotions, white);
+	}
 
-		Utils::popBit(friendly_pieces, from);
+	// The king isn't limited by the check mask, only by the attacked squares
+	uint64_t king_moves = Moves::getKingMoves(king) & targets;
+	if (type != GEN_NOISY && (pos.castling_rights & (white ? 0x03 : 0x0C)) && king == (white ? 4 : 60)) {
+		king_moves |= getCastlingMoves(white);
 	}
+	king_moves &= ~pos.attack_squares;
 
-	// Sort only the portion containing actual moves
-	std::sort(move_scores.begin(), move_scores.begin() + move_count,
-		[](const auto& a, const auto& b) { return a.second > b.second; });
+	while (king_moves) {
+		int to = Utils::findFirstSetBit(king_moves);
+		Utils::popBit(king_moves, to);
 
-	// Extract just the moves
-	for (int i = 0; i < move_count; ++i) {
-		move_list[i] = move_scores[i].first;
+		PieceType target_piece = pos.piece_at_square[to];
+		move_list[move_count++] = { ChessAI::encodeMove(king, to, KING, target_piece,
+			getMoveType(king, to, KING, target_piece, white), EMPTY, false), 0 };
 	}
 }
 
-void Bitboard::generateEndgameMoves(std::array<uint32_t, MAX_MOVES>&move_list, int& move_count, int depth, bool white, uint32_t move_hint) {
-	move_count = 0;
-	std::array<std::pair<uint32_t, int>, MAX_MOVES> move_scores; // Stack allocated array
+void Bitboard::generatePawnMoves(std::array<ScoredMove, MAX_MOVES>& move_list, int& move_count, uint64_t pawns, uint64_t allowed,
+	uint64_t empty, uint64_t opponent, GenType type, bool underpromotions, bool white) {
+	if (!pawns) return;
+
+	int up = white ? NORTH : SOUTH;
+	int up_west = white ? NORTH_WEST : SOUTH_WEST;
+	int up_east = white ? NORTH_EAST : SOUTH_EAST;
+	uint64_t promotion_rank = white ? RANK_8 : RANK_1;
+
+	// A double push needs the single push square empty as well
+	uint64_t single_pushes = Utils::shift(pawns, up) & empty;
+	uint64_t double_pushes = Utils::shift(single_pushes & (white ? RANK_3 : RANK_6), up) & empty & allowed;
+	single_pushes &= allowed;
+
+	if (type != GEN_QUIET) {
+		uint64_t west_captures = Utils::shift(pawns & ~FILE_A, up_west) & opponent & allowed;
+		uint64_t east_captures = Utils::shift(pawns & ~FILE_H, up_east) & opponent & allowed;
+
+		addPawnMoves(move_list, move_count, west_captures & promotion_rank, up_west, PROMOTION_CAPTURE, underpromotions);
+		addPawnMoves(move_list, move_count, east_captures & promotion_rank, up_east, PROMOTION_CAPTURE, underpromotions);
+		addPawnMoves(move_list, move_count, single_pushes & promotion_rank, up, PROMOTION, underpromotions);
+		addPawnMoves(move_list, move_count, west_captures & ~promotion_rank, up_west, CAPTURE, false);
+		addPawnMoves(move_list, move_count, east_captures & ~promotion_rank, up_east, CAPTURE, false);
+
+		// En passant target is found from the pawns attacking it
+		if (pos.en_passant_target != UNASSIGNED && (allowed & (1ULL << pos.en_passant_target))) {
+			uint64_t capturers = Moves::getPawnCaptures(pos.en_passant_target, !white) & pawns;
+			while (capturers) {
+				int from = Utils::findFirstSetBit(capturers);
+				Utils::popBit(capturers, from);
+				move_list[move_count++] = { ChessAI::encodeMove(from, pos.en_passant_target, PAWN, EMPTY, EN_PASSANT, EMPTY, false), 0 };
+			}
+		}
+	}
 
-	// Generate all moves directly into move_scores with scoring
-	uint64_t friendly_pieces = white ? whitePieces() : blackPieces();
-	uint64_t opponent_pieces = white ? blackPieces() : whitePieces();
+	if (type != GEN_NOISY) {
+		addPawnMoves(move_list, move_count, single_pushes & ~promotion_rank, up, NORMAL, false);
+		addPawnMoves(move_list, move_count, double_pushes, 2 * up, PAWN_DOUBLE_PUSH, false);
+	}
+}
 
-	// Determine if we are in winning position (simplified)
-	bool winning_position = white ? (evaluateBoard() >= 0) : (evaluateBoard() < 0);
+void Bitboard::addPawnMoves(std::array<ScoredMove, MAX_MOVES>& move_list, int& move_count, uint64_t targets, int offset,
+	MoveType move_type, bool underpromotions) {
+	bool promoting = move_type == PROMOTION || move_type == PROMOTION_CAPTURE;
 
-	// Get squares where we can check the enemy king
-	int enemy_king = Utils::findFirstSetBit(piece_bitboards[!white][KING]);
-	KingDanger king_danger = Moves::computeKingDanger(enemy_king, friendly_pieces | opponent_pieces, white);
+	while (targets) {
+		int to = Utils::findFirstSetBit(targets);
+		Utils::popBit(targets, to);
 
-	while (friendly_pieces) {
-		int from = Utils::findFirstSetBit(friendly_pieces);
-		Utils::popBit(friendly_pieces, from);
+		int from = to - offset;
+		PieceType target_piece = pos.piece_at_square[to];
 
-		PieceType piece = piece_at_square[from];
-		uint64_t legal_moves = getLegalMoves(from, white);
+		if (!promoting) {
+			move_list[move_count++] = { ChessAI::encodeMove(from, to, PAWN, target_piece, move_type, EMPTY, false), 0 };
+			continue;
+		}
+		move_list[move_count++] = { ChessAI::encodeMove(from, to, PAWN, target_piece, move_type, QUEEN, false), 0 };
+		if (underpromotions) {
+			move_list[move_count++] = { ChessAI::encodeMove(from, to, PAWN, target_piece, move_type, ROOK, false), 0 };
+			move_list[move_count++] = { ChessAI::encodeMove(from, to, PAWN, target_piece, move_type, BISHOP, false), 0 };
+			move_list[move_count++] = { ChessAI::encodeMove(from, to, PAWN, target_piece, move_type, KNIGHT, false), 0 };
+		}
+	}
+}
 
-		while (legal_moves) {
-			int to = Utils::findFirstSetBit(legal_moves);
-			Utils::popBit(legal_moves, to);
+uint32_t Bitboard::decodeMove(uint16_t move, bool white, bool endgame) {
+	if (move == NULL_MOVE) return NULL_MOVE_32;
 
-			PieceType target_piece = piece_at_square[to];
-			MoveType move_type = getMoveType(from, to, piece, target_piece, white);
-			bool is_check = isCheckMove(king_danger, to, piece);
+	int from = ChessAI::compactFrom(move);
+	int to = ChessAI::compactTo(move);
+	PieceType piece = pos.piece_at_square[from];
 
-			// --- Scoring Logic ---
-			int score = 0; // Default score for quiet moves at depth 0 or unhandled cases
+	// The piece has to be ours
+	if (piece == EMPTY || !(pos.piece_bitboards[white][piece] & (1ULL << from))) return NULL_MOVE_32;
 
-			// Checks are absolute priorities, gives highest score
-			if (is_check) score += CHECK_MOVE_SCORE;
+	PieceType target_piece = pos.piece_at_square[to];
+	MoveType move_type = getMoveType(from, to, piece, target_piece, white);
 
-			// Score captures with endgame specific MVV-LVA
-			if (move_type == CAPTURE || move_type == PROMOTION_CAPTURE || move_type == EN_PASSANT) {
-				PieceType victim = (move_type == EN_PASSANT) ? PAWN : target_piece;
-				score += MVV_LVA_ENDGAME[victim][piece];
+	// The promotion field has to agree with the board
+	PieceType promotion = ChessAI::compactPromotion(move);
+	bool promoting = move_type == PROMOTION || move_type == PROMOTION_CAPTURE;
+	if (promoting != (promotion != EMPTY)) return NULL_MOVE_32;
 
-				// Penalize losing trades in winning positions
-				if (winning_position && PIECE_VALUES[piece] > PIECE_VALUES[victim]) {
-					score -= LOSING_TRADE_PENALTY;
-				}
-			}
-			// Killer moves and history heuristics for quiet moves
-			else if (depth > 0) {
-				if (ChessAI::isKillerMove(from, to, piece, depth)) {
-					score += (piece == PAWN) ? PAWN_KILLER_SCORE : (piece == KING) ? KING_KILLER_SCORE : ENDGAME_KILLER_SCORE;
-				}
-				score += ChessAI::getHistoryScore(from, to, piece) / HISTORY_SCORE_SCALEFACTOR; // History score is scaled down (prevent domination)
-			}
+	// Check moves are only encoded by the endgame generators
+	bool is_check = false;
+	if (endgame) {
+		int enemy_king = Utils::findFirstSetBit(pos.piece_bitboards[!white][KING]);
+		KingDanger king_danger = Moves::computeKingDanger(enemy_king, occupiedSquares(), white);
+		is_check = isCheckMove(king_danger, to, piece);
+	}
 
-			if (piece == PAWN && isPassedPawn(to, white)) {
-				score += PASSED_PAWN_SCORE + PASSED_PAWN_RANK_MULTIPLIER * (white ? (to / 8) : (7 - to / 8)); // Passed pawn push
-			}
+	return ChessAI::encodeMove(from, to, piece, target_piece, move_type, promotion, is_check);
+}
 
-			if (piece == KING) {
-				score += 600 * (4 - CENTRALITY_DISTANCE[to]); // King activity
-			}
+bool Bitboard::isLegalMove(uint32_t move, bool white, bool endgame) {
+	int from = ChessAI::from(move);
+	int to = ChessAI::to(move);
+	PieceType piece = pos.piece_at_square[from];
 
-			// --- Encode Move(s) and Apply TT Bonus ---
-			if (move_type == PROMOTION || move_type == PROMOTION_CAPTURE) {
-				PieceType promotions[] = { QUEEN, ROOK, BISHOP, KNIGHT }; // Order Q>N>R>B? maybe better
-				int promotion_base_score = score + PROMOTION_SCORE; // Add base promotion bonus
+	// The piece has to be ours and reach the target legally
+	if (piece == EMPTY || !(pos.piece_bitboards[white][piece] & (1ULL << from))) return false;
+	if (!(getLegalMoves(from, white) & (1ULL << to))) return false;
 
-				for (PieceType pt : promotions) {
-					uint32_t move = ChessAI::encodeMove(from, to, piece, target_piece, move_type, pt, is_check);
-					// Check if this specific promotion move matches the hint
-					int final_score = (move_hint != NULL_MOVE_32 && move == move_hint) ? TT_MOVE_SCORE : promotion_base_score + PROMOTION_SCORES[4 - pt];
-					move_scores[move_count++] = { move, final_score };
-				}
-			}
-			else {
-				uint32_t move = ChessAI::encodeMove(from, to, piece, target_piece, move_type, EMPTY, is_check);
-				// Check if this regular move matches the hint
-				int final_score = (move_hint != NULL_MOVE_32 && move == move_hint) ? TT_MOVE_SCORE : score;
-				move_scores[move_count++] = { move, final_score };
-			}
-		}
+	// Midgame generators only promote to a queen, endgame ones to any piece
+	MoveType move_type = ChessAI::moveType(move);
+	if (move_type == PROMOTION || move_type == PROMOTION_CAPTURE) {
+		PieceType promotion = ChessAI::promotion(move);
+		if (endgame ? (promotion < KNIGHT || promotion > QUEEN) : promotion != QUEEN) return false;
 	}
+	return true;
+}
 
-	// Sort only the portion containing actual moves
-	std::sort(move_scores.begin(), move_scores.begin() + move_count,
-		[](const auto& a, const auto& b) { return a.second > b.second; });
+uint32_t Bitboard::quietMoveFromKey(uint16_t key, bool white) {
+	// Key layout of ChessAI::moveKey: from << 10 | to << 4 | piece
+	int from = (key >> 10) & 0x3F;
+	int to = (key >> 4) & 0x3F;
+	PieceType piece = static_cast<PieceType>(key & 0xF);
 
-	// Extract just the moves
-	for (int i = 0; i < move_count; ++i) {
-		move_list[i] = move_scores[i].first;
-	}
-}
+	if (pos.piece_at_square[from] != piece || pos.piece_at_square[to] != EMPTY) return NULL_MOVE_32;
+
+	MoveType move_type = getMoveType(from, to, piece, EMPTY, white);
+	if (move_type != NORMAL && move_type != CASTLING && move_type != PAWN_DOUBLE_PUSH) return NULL_MOVE_32;
 
-void Bitboard::generateEndgameNoisyMoves(std::array<uint32_t, MAX_MOVES>& move_list, int& move_count, bool white) {
-	move_count = 0;
-	std::array<std::pair<uint32_t, int>, MAX_MOVES> move_scores; // Stack allocated array
+	uint32_t move = ChessAI::encodeMove(from, to, piece, EMPTY, move_type, EMPTY, false);
+	return isLegalMove(move, white, false) ? move : NULL_MOVE_32;
+}
 
-	// Generate all moves directly into move_scores with scoring
-	uint64_t friendly_pieces = white ? whitePieces() : blackPieces();
-	uint64_t opponent_pieces = white ? blackPieces() : whitePieces();
+void Bitboard::generateEndgameMoves(std::array<ScoredMove, MAX_MOVES>& move_list, int& move_count, int depth, bool white) {
+	int first = move_count;
+	generateLegalMoves(move_list, move_count, GEN_ALL, true, white);
 
 	// Determine if we are in winning position (simplified)
 	bool winning_position = white ? (evaluateBoard() >= 0) : (evaluateBoard() < 0);
 
 	// Get squares where we can check the enemy king
-	int enemy_king = Utils::findFirstSetBit(piece_bitboards[!white][KING]);
-	KingDanger king_danger = Moves::computeKingDanger(enemy_king, friendly_pieces | opponent_pieces, white);
-
-	while (friendly_pieces) {
-		int from = Utils::findFirstSetBit(friendly_pieces);
-		Utils::popBit(friendly_pieces, from);
+	int enemy_king = Utils::findFirstSetBit(pos.piece_bitboards[!white][KING]);
+	KingDanger king_danger = Moves::computeKingDanger(enemy_king, occupiedSquares(), white);
+
+	for (int i = first; i < move_count; i++) {
+		uint32_t move = move_list[i].move;
+		int from = ChessAI::from(move);
+		int to = ChessAI::to(move);
+		PieceType piece = ChessAI::piece(move);
+		PieceType target_piece = ChessAI::capturedPiece(move);
+		MoveType move_type = ChessAI::moveType(move);
+		bool is_check = isCheckMove(king_danger, to, piece);
+
+		// --- Scoring Logic ---
+		int score = 0; // Default score for quiet moves at depth 0 or unhandled cases
+
+		// Checks are absolute priorities, gives highest score
+		if (is_check) score += CHECK_MOVE_SCORE;
+
+		// Score captures with endgame specific MVV-LVA
+		if (move_type == CAPTURE || move_type == PROMOTION_CAPTURE || move_type == EN_PASSANT) {
+			PieceType victim = (move_type == EN_PASSANT) ? PAWN : target_piece;
+			score += MVV_LVA_ENDGAME[victim][piece];
+
+			// Penalize losing trades in winning positions
+			if (winning_position && PIECE_VALUES[piece] > PIECE_VALUES[victim]) {
+				score -= LOSING_TRADE_PENALTY;
+			}
+		}
+		// Killer moves and history heuristics for quiet moves
+		else if (depth > 0) {
+			if (ChessAI::isKillerMove(from, to, piece, search_ply)) {
+				score += (piece == PAWN) ? PAWN_KILLER_SCORE : (piece == KING) ? KING_KILLER_SCORE : ENDGAME_KILLER_SCORE;
+			}
+			score += ChessAI::getHistoryScore(from, to, piece) / HISTORY_SCORE_SCALEFACTOR; // History score is scaled down (prevent domination)
+		}
 
-		PieceType piece = piece_at_square[from];
-		uint64_t legal_moves = getLegalMoves(from, white);
+		if (piece == PAWN && isPassedPawn(to, white)) {
+			score += PASSED_PAWN_SCORE + PASSED_PAWN_RANK_MULTIPLIER * (white ? (to / 8) : (7 - to / 8)); // Passed pawn push
+		}
 
-		while (legal_moves) {
-			int to = Utils::findFirstSetBit(legal_moves);
-			Utils::popBit(legal_moves, to);
+		if (piece == KING) {
+			score += 600 * (4 - CENTRALITY_DISTANCE[to]); // King activity
+		}
 
-			PieceType target_piece = piece_at_square[to];
-			MoveType move_type = getMoveType(from, to, piece, target_piece, white);
+		// Promotions get the promotion bonus by the promoted piece
+		if (move_type == PROMOTION || move_type == PROMOTION_CAPTURE) {
+			score += PROMOTION_SCORE + PROMOTION_SCORES[4 - ChessAI::promotion(move)];
+		}
 
-			// Filter: Only include captures, checks, and promotions
-			bool is_check = isCheckMove(king_danger, to, piece);
-			bool is_quiet = (move_type == NORMAL || move_type == CASTLING);
-			if (is_quiet && !is_check) continue;
+		move_list[i] = { ChessAI::encodeMove(from, to, piece, target_piece, move_type, ChessAI::promotion(move), is_check), score };
+	}
+}
 
-			int score = 0;
+void Bitboard::generateEndgameNoisyMoves(std::array<ScoredMove, MAX_MOVES>& move_list, int& move_count, bool white) {
+	int first = move_count;
+	generateLegalMoves(move_list, move_count, GEN_ALL, true, white);
 
-			// Checks get highest priority
-			if (is_check) score += CHECK_MOVE_SCORE;
+	// Determine if we are in winning position (simplified)
+	bool winning_position = white ? (evaluateBoard() >= 0) : (evaluateBoard() < 0);
 
-			// Promotions (queen only)
-			if (move_type == PROMOTION || move_type == PROMOTION_CAPTURE) {
-				score += PROMOTION_SCORE;
-				// Bonus for passed pawn promotions
-				if (piece == PAWN && isPassedPawn(from, white)) {
-					score += PASSED_PAWN_SCORE + PASSED_PAWN_RANK_MULTIPLIER * (white ? (to / 8) : (7 - to / 8));
-				}
+	// Get squares where we can check the enemy king
+	int enemy_king = Utils::findFirstSetBit(pos.piece_bitboards[!white][KING]);
+	KingDanger king_danger = Moves::computeKingDanger(enemy_king, occupiedSquares(), white);
+
+	// Quiet moves are dropped, the rest is packed to the front
+	int kept = first;
+	for (int i = first; i < move_count; i++) {
+		uint32_t move = move_list[i].move;
+		int from = ChessAI::from(move);
+		int to = ChessAI::to(move);
+		PieceType piece = ChessAI::piece(move);
+		PieceType target_piece = ChessAI::capturedPiece(move);
+		MoveType move_type = ChessAI::moveType(move);
+
+		// Filter: Only include captures, checks, and promotions
+		bool is_check = isCheckMove(king_danger, to, piece);
+		bool is_quiet = (move_type == NORMAL || move_type == CASTLING);
+		if (is_quiet && !is_check) continue;
+
+		int score = 0;
+
+		// Checks get highest priority
+		if (is_check) score += CHECK_MOVE_SCORE;
+
+		// Promotions, by the promoted piece
+		if (move_type == PROMOTION || move_type == PROMOTION_CAPTURE) {
+			score += PROMOTION_SCORE;
+			// Bonus for passed pawn promotions
+			if (piece == PAWN && isPassedPawn(from, white)) {
+				score += PASSED_PAWN_SCORE + PASSED_PAWN_RANK_MULTIPLIER * (white ? (to / 8) : (7 - to / 8));
 			}
+			PieceType promotion = ChessAI::promotion(move);
+			score += (promotion == QUEEN) ? QUEEN_PROMOTION : (promotion == ROOK) ? ROOK_PROMOTION : BN_PROMOTION;
+		}
 
-			// Captures with MVV_LVA (penalize bad trades when winning)
-			if (move_type == CAPTURE || move_type == PROMOTION_CAPTURE || move_type == EN_PASSANT) {
-				PieceType victim = (move_type == EN_PASSANT) ? PAWN : target_piece;
-				score += MVV_LVA_ENDGAME[victim][piece];
+		// Captures with MVV_LVA (penalize bad trades when winning)
+		if (move_type == CAPTURE || move_type == PROMOTION_CAPTURE || move_type == EN_PASSANT) {
+			PieceType victim = (move_type == EN_PASSANT) ? PAWN : target_piece;
+			score += MVV_LVA_ENDGAME[victim][piece];
 
-				// Penalize losing trades in winning positions
-				if (winning_position && PIECE_VALUES[piece] > PIECE_VALUES[victim]) {
-					score -= LOSING_TRADE_PENALTY;
-				}
+			// Penalize losing trades in winning positions
+			if (winning_position && PIECE_VALUES[piece] > PIECE_VALUES[victim]) {
+				score -= LOSING_TRADE_PENALTY;
 			}
+		}
 
-			// King activity - only for moves that gain opposition/centralization
-			if (piece == KING) {
-				// Only score king moves if they improve position
-				score += 200 * (4 - CENTRALITY_DISTANCE[to]); // Centralization bonus
-
-				// TODO
-			
-				//if (isOppositionGainingMove(from, to, white)) {
-				//	score += 800; // Big bonus for gaining opposition
-				//}
-			}
+		// King activity - only for moves that gain opposition/centralization
+		if (piece == KING) {
+			// Only score king moves if they improve position
+			score += 200 * (4 - CENTRALITY_DISTANCE[to]); // Centralization bonus
 
-			// Encode move
-			if (move_type == PROMOTION || move_type == PROMOTION_CAPTURE) {
-				move_scores[move_count++] = { ChessAI::encodeMove(from, to, piece, target_piece, move_type, QUEEN, is_check), score + QUEEN_PROMOTION};
-				move_scores[move_count++] = { ChessAI::encodeMove(from, to, piece, target_piece, move_type, ROOK, is_check), score + ROOK_PROMOTION };
-				move_scores[move_count++] = { ChessAI::encodeMove(from, to, piece, target_piece, move_type, BISHOP, is_check), score + BN_PROMOTION };
-				move_scores[move_count++] = { ChessAI::encodeMove(from, to, piece, target_piece, move_type, KNIGHT, is_check), score + BN_PROMOTION };
-			}
-			else {
-				move_scores[move_count++] = { ChessAI::encodeMove(from, to, piece, target_piece, move_type, EMPTY, is_check), score };
-			}
+			// TODO
+		
+			//if (isOppositionGainingMove(from, to, white)) {
+			//	score += 800; // Big bonus for gaining opposition
+			//}
 		}
-	}
-
-	// Sort only the portion containing actual moves
-	std::sort(move_scores.begin(), move_scores.begin() + move_count,
-		[](const auto& a, const auto& b) { return a.second > b.second; });
 
-	// Extract just the moves
-	for (int i = 0; i < move_count; ++i) {
-		move_list[i] = move_scores[i].first;
+		move_list[kept++] = { ChessAI::encodeMove(from, to, piece, target_piece, move_type, ChessAI::promotion(move), is_check), score };
 	}
+	move_count = kept;
 }
 
 void Bitboard::applyMoveAI(uint32_t move, bool white) {
@@ -989,49 +1113,50 @@ void Bitboard::applyMoveAI(uint32_t move, bool white) {
 	MoveType move_type = ChessAI::moveType(move);
 	PieceType promotion = ChessAI::promotion(move);
 
-	// Save state to undo stack
-	UndoInfo current;
-	current.castling_rights = castling_rights;
-	current.en_passant_target = en_passant_target;
-	current.flags = state.flags;
-	current.half_moves = half_moves;
-	// Board score deltas are stored after move has been applied
+	// Copy-make saves the whole position, undoing doesn't need the undo info then
+	if (copy_make) search_stack[search_ply].position = pos;
 
-	// Save current state hash in history before making the move
-	search_history.push_back(hash_key);
+	// Save state to the search stack entry of this ply
+	UndoInfo& current = search_stack[search_ply].undo;
+	current.castling_rights = pos.castling_rights;
+	current.en_passant_target = pos.en_passant_target;
+	current.flags = pos.state.flags;
+	current.half_moves = pos.half_moves;
+	saveLegalityData(current);
+	// Board score deltas are stored after move has been applied
 
-	float previous_game_phase = std::max(0.0f, std::min(1.0f, static_cast<float>(game_phase_score) / MAX_GAME_PHASE)); // Store previous phase
+	float previous_game_phase = std::max(0.0f, std::min(1.0f, static_cast<float>(pos.game_phase_score) / MAX_GAME_PHASE)); // Store previous phase
 	int material_delta = 0; // Count material losses/gains in this move
 	int positional_delta = 0; // Change of positional score with move
 	int game_phase_delta = 0; // Change of game phase score
 
 	// Clear the source square, doesn't differ for any move
-	piece_bitboards[white][source_piece] &= ~(1ULL << source);
-	piece_at_square[source] = EMPTY;
-	hash_key ^= Tables::PIECE_KEYS[white][source_piece][source];
+	removePiece(white, source_piece, 1ULL << source);
+	pos.piece_at_square[source] = EMPTY;
+	pos.hash_key ^= Tables::PIECE_KEYS[white][source_piece][source];
 
 	// Clear positional score of source square
 	positional_delta -= getPositionalScore(source, previous_game_phase, source_piece, white);
 
 	// Precompute whether castling is affected
-	bool castling_affected = (castling_rights & (white ? 0x03 : 0x0C)) != 0;
-	hash_key ^= Tables::CASTLING_KEYS[castling_rights]; // Remove previous rights
+	bool castling_affected = (pos.castling_rights & (white ? 0x03 : 0x0C)) != 0;
+	pos.hash_key ^= Tables::CASTLING_KEYS[pos.castling_rights]; // Remove previous rights
 
 	// If a rook or knight moved, update castling rights
 	if (castling_affected && (source_piece == ROOK || source_piece == KING)) {
 		if (source_piece == ROOK) updateRookCastling(white, source);
-		else if (source_piece == KING) castling_rights &= ~(white ? 0x03 : 0x0C);  // Disable castling rights
+		else if (source_piece == KING) pos.castling_rights &= ~(white ? 0x03 : 0x0C);  // Disable castling rights
 	}
 	
 	// If capture, clear target square and update scores
 	if (move_type == CAPTURE || move_type == PROMOTION_CAPTURE) {
-		piece_bitboards[!white][target_piece] &= ~(1ULL << target);
-		hash_key ^= Tables::PIECE_KEYS[!white][target_piece][target];
+		removePiece(!white, target_piece, 1ULL << target);
+		pos.hash_key ^= Tables::PIECE_KEYS[!white][target_piece][target];
 
 		// Update game phase
 		if (target_piece == QUEEN) game_phase_delta -= 4;
 		else if (target_piece == ROOK) {
-			if ((castling_rights & (white ? 0x0C : 0x03)) != 0) updateRookCastling(!white, target); // Update castling
+			if ((pos.castling_rights & (white ? 0x0C : 0x03)) != 0) updateRookCastling(!white, target); // Update castling
 			game_phase_delta -= 2;
 		}
 		else if (target_piece == KNIGHT || target_piece == BISHOP) game_phase_delta -= 1;
@@ -1047,9 +1172,9 @@ void Bitboard::applyMoveAI(uint32_t move, bool white) {
 	if (move_type == EN_PASSANT) {
 		// Compute the pawn captured by en passant
 		int en_passant_square = white ? (target - 8) : (target + 8);
-		piece_bitboards[!white][PAWN] &= ~(1ULL << en_passant_square); // Capture pawn
-		piece_at_square[en_passant_square] = EMPTY;
-		hash_key ^= Tables::PIECE_KEYS[!white][PAWN][en_passant_square];
+		removePiece(!white, PAWN, 1ULL << en_passant_square); // Capture pawn
+		pos.piece_at_square[en_passant_square] = EMPTY;
+		pos.hash_key ^= Tables::PIECE_KEYS[!white][PAWN][en_passant_square];
 
 		material_delta += PIECE_VALUES[PAWN];
 		positional_delta += getPositionalScore(en_passant_square, previous_game_phase, PAWN, !white);
@@ -1066,8 +1191,8 @@ void Bitboard::applyMoveAI(uint32_t move, bool white) {
 		int rook_origin = white ? (kingside ? 7 : 0) : (kingside ? 63 : 56);
 		int rook_target = white ? (kingside ? 5 : 3) : (kingside ? 61 : 59);
 
-		hash_key ^= Tables::PIECE_KEYS[white][ROOK][rook_origin];
-		hash_key ^= Tables::PIECE_KEYS[white][ROOK][rook_target];
+		pos.hash_key ^= Tables::PIECE_KEYS[white][ROOK][rook_origin];
+		pos.hash_key ^= Tables::PIECE_KEYS[white][ROOK][rook_target];
 
 		positional_delta -= getPositionalScore(rook_origin, previous_game_phase, ROOK, white);
 		positional_delta += getPositionalScore(rook_target, previous_game_phase, ROOK, white);
@@ -1076,9 +1201,9 @@ void Bitboard::applyMoveAI(uint32_t move, bool white) {
 	// Promotion
 	if (move_type == PROMOTION || move_type == PROMOTION_CAPTURE) {
 		// Update promoted pieces bitboard
-		piece_bitboards[white][promotion] |= (1ULL << target);
-		piece_at_square[target] = promotion;
-		hash_key ^= Tables::PIECE_KEYS[white][promotion][target];
+		placePiece(white, promotion, 1ULL << target);
+		pos.piece_at_square[target] = promotion;
+		pos.hash_key ^= Tables::PIECE_KEYS[white][promotion][target];
 
 		// Update game phase score
 		if (promotion == QUEEN) game_phase_delta += 4;
@@ -1091,37 +1216,37 @@ void Bitboard::applyMoveAI(uint32_t move, bool white) {
 		positional_delta += getPositionalScore(target, previous_game_phase, promotion, white);
 	}
 	else { // For the non promotion moves move source piece to target
-		piece_bitboards[white][source_piece] |= (1ULL << target);
-		piece_at_square[target] = source_piece;
-		hash_key ^= Tables::PIECE_KEYS[white][source_piece][target];
+		placePiece(white, source_piece, 1ULL << target);
+		pos.piece_at_square[target] = source_piece;
+		pos.hash_key ^= Tables::PIECE_KEYS[white][source_piece][target];
 	}
 
 	// Clear previous en passant
-	if (en_passant_target != UNASSIGNED) {
-		hash_key ^= Tables::EN_PASSANT_KEYS[en_passant_target % 8];
+	if (pos.en_passant_target != UNASSIGNED) {
+		pos.hash_key ^= Tables::EN_PASSANT_KEYS[pos.en_passant_target % 8];
 	}
 
-	hash_key ^= Tables::CASTLING_KEYS[castling_rights]; // Set new castling rights
+	pos.hash_key ^= Tables::CASTLING_KEYS[pos.castling_rights]; // Set new castling rights
 
 	// Set en passant target if a pawn double pushes
 	if (move_type == PAWN_DOUBLE_PUSH) {
-		en_passant_target = white ? (source + 8) : (target + 8);
-		hash_key ^= Tables::EN_PASSANT_KEYS[target % 8];
+		pos.en_passant_target = white ? (source + 8) : (target + 8);
+		pos.hash_key ^= Tables::EN_PASSANT_KEYS[target % 8];
 	}
 	else {
-		en_passant_target = UNASSIGNED;
+		pos.en_passant_target = UNASSIGNED;
 	}
 
 	// Toggle side to move
-	hash_key ^= Tables::SIDE_TO_MOVE_KEY;
+	pos.hash_key ^= Tables::SIDE_TO_MOVE_KEY;
 
 	// For reversible moves increment half-moves
 	// Count incremented for both
 	if (!(source_piece == PAWN || move_type == CAPTURE || move_type == CASTLING)) {
-		half_moves++;
+		pos.half_moves++;
 	}
 	else {
-		half_moves = 0; // Reset half-moves if irreversible
+		pos.half_moves = 0; // Reset half-moves if irreversible
 	}
 
 	// Apply score deltas
@@ -1130,31 +1255,43 @@ void Bitboard::applyMoveAI(uint32_t move, bool white) {
 		positional_delta = -positional_delta;
 	}
 
-	material_score += material_delta;
-	positional_score += positional_delta;
-	game_phase_score += game_phase_delta;
+	pos.material_score += material_delta;
+	pos.positional_score += positional_delta;
+	pos.game_phase_score += game_phase_delta;
 
-	// Save deltas and undo-info to stack
+	// Save deltas to the undo-info
 	current.material_delta = material_delta;
 	current.positional_delta = positional_delta;
 	current.game_phase_delta = game_phase_delta;
-	undo_stack.push_back(current);
+	search_ply++;
 
 	// Compute new game phase (clamped 0-1 range)
-	float new_game_phase = std::max(0.0f, std::min(1.0f, static_cast<float>(game_phase_score) / MAX_GAME_PHASE));
+	float new_game_phase = std::max(0.0f, std::min(1.0f, static_cast<float>(pos.game_phase_score) / MAX_GAME_PHASE));
 
 	// **Check if the phase change is large enough for a full recalculation**
 	float phase_change = abs(new_game_phase - previous_game_phase);
 	if (phase_change >= FULL_RECALC_THRESHOLD) {
+		int previous_positional_score = pos.positional_score - positional_delta;
 		updatePositionalScore();
+		// Undoing has to restore the score before the move, not only the incremental part
+		current.positional_delta = pos.positional_score - previous_positional_score;
 	}
 
+	assert(isOccupancyConsistent());
 	updateBoardState(white); // Update board state after applied move (+promoted)
 
-	ply_count++; 
+	pos.ply_count++;
+	key_history[pos.ply_count & KEY_HISTORY_MASK] = pos.hash_key; // Search keys continue from the game keys
 }
 
 void Bitboard::undoMoveAI(uint32_t move, bool white) {
+	// Copy-make: the position before the move is on the stack as a whole
+	if (copy_make) {
+		search_ply--;
+		pos = search_stack[search_ply].position;
+		return;
+	}
+
 	// Decode the move
 	int source = ChessAI::from(move);
 	int target = ChessAI::to(move);
@@ -1164,55 +1301,55 @@ void Bitboard::undoMoveAI(uint32_t move, bool white) {
 	PieceType promotion = ChessAI::promotion(move);
 
 	// --- Undo Board and Hash Modifications (Reverse order of applyMove) ---
-	search_history.pop_back(); // Pop the history stack
+	search_ply--; // Back to the entry of this move
 
-	hash_key ^= Tables::SIDE_TO_MOVE_KEY; // Toggle side to move
+	pos.hash_key ^= Tables::SIDE_TO_MOVE_KEY; // Toggle side to move
 
 	if (move_type == PAWN_DOUBLE_PUSH) {
-		hash_key ^= Tables::EN_PASSANT_KEYS[target % 8];
+		pos.hash_key ^= Tables::EN_PASSANT_KEYS[target % 8];
 	}
-	hash_key ^= Tables::CASTLING_KEYS[castling_rights];
+	pos.hash_key ^= Tables::CASTLING_KEYS[pos.castling_rights];
 
 	// Restore board state
-	const UndoInfo& prev = undo_stack.back();
-	castling_rights = prev.castling_rights;
-	en_passant_target = prev.en_passant_target;
-	state.flags = prev.flags;
-	material_score -= prev.material_delta;
-	positional_score -= prev.positional_delta;
-	game_phase_score -= prev.game_phase_delta;
-	half_moves = prev.half_moves;
-	undo_stack.pop_back(); // Pop the undo stack
+	const UndoInfo& prev = search_stack[search_ply].undo;
+	pos.castling_rights = prev.castling_rights;
+	pos.en_passant_target = prev.en_passant_target;
+	pos.state.flags = prev.flags;
+	pos.material_score -= prev.material_delta;
+	pos.positional_score -= prev.positional_delta;
+	pos.game_phase_score -= prev.game_phase_delta;
+	pos.half_moves = prev.half_moves;
+	restoreLegalityData(prev);
 
 	// Apply restored castling rights and en passant
-	if (en_passant_target != UNASSIGNED) {
-		hash_key ^= Tables::EN_PASSANT_KEYS[en_passant_target % 8];
+	if (pos.en_passant_target != UNASSIGNED) {
+		pos.hash_key ^= Tables::EN_PASSANT_KEYS[pos.en_passant_target % 8];
 	}
-	hash_key ^= Tables::CASTLING_KEYS[prev.castling_rights];
+	pos.hash_key ^= Tables::CASTLING_KEYS[prev.castling_rights];
 
 	// Move source piece back to source square
 	// Doesn't differ for any move type
-	piece_bitboards[white][source_piece] |= 1ULL << source; // Move to original position
-	hash_key ^= Tables::PIECE_KEYS[white][source_piece][source];
+	placePiece(white, source_piece, 1ULL << source); // Move to original position
+	pos.hash_key ^= Tables::PIECE_KEYS[white][source_piece][source];
 
-	piece_at_square[source] = source_piece; // Restore piece type
-	piece_at_square[target] = target_piece; // Restore target
+	pos.piece_at_square[source] = source_piece; // Restore piece type
+	pos.piece_at_square[target] = target_piece; // Restore target
 
 	// Handle special cases
 
 	// Restore captured piece if move was a capture
 	if (move_type == CAPTURE || move_type == PROMOTION_CAPTURE) {
-		piece_bitboards[!white][target_piece] |= 1ULL << target; // Restore captured piece
-		hash_key ^= Tables::PIECE_KEYS[!white][target_piece][target];
+		placePiece(!white, target_piece, 1ULL << target); // Restore captured piece
+		pos.hash_key ^= Tables::PIECE_KEYS[!white][target_piece][target];
 	}
 
 	// Restore en passant pawn if move was en passant
 	if (move_type == EN_PASSANT) {
 		// Determine en passant square
 		int en_passant_square = white ? (target - 8) : (target + 8);
-		piece_bitboards[!white][PAWN] |= 1ULL << en_passant_square; // Restore captured pawn
-		piece_at_square[en_passant_square] = PAWN; // Also restore piece type
-		hash_key ^= Tables::PIECE_KEYS[!white][PAWN][en_passant_square];
+		placePiece(!white, PAWN, 1ULL << en_passant_square); // Restore captured pawn
+		pos.piece_at_square[en_passant_square] = PAWN; // Also restore piece type
+		pos.hash_key ^= Tables::PIECE_KEYS[!white][PAWN][en_passant_square];
 	}
 
 	// Restore rook to original position if move was castling
@@ -1226,31 +1363,100 @@ void Bitboard::undoMoveAI(uint32_t move, bool white) {
 		int rook_origin = white ? (kingside ? 7 : 0) : (kingside ? 63 : 56);
 		int rook_target = white ? (kingside ? 5 : 3) : (kingside ? 61 : 59);
 
-		hash_key ^= Tables::PIECE_KEYS[white][ROOK][rook_target];
-		hash_key ^= Tables::PIECE_KEYS[white][ROOK][rook_origin];
+		pos.hash_key ^= Tables::PIECE_KEYS[white][ROOK][rook_target];
+		pos.hash_key ^= Tables::PIECE_KEYS[white][ROOK][rook_origin];
 	}
 
 	// Restore promotion piece if move was promotion
 	if (move_type == PROMOTION || move_type == PROMOTION_CAPTURE) {
-		piece_bitboards[white][promotion] &= ~(1ULL << target); // Clear promotion square
-		hash_key ^= Tables::PIECE_KEYS[white][promotion][target];
+		removePiece(white, promotion, 1ULL << target); // Clear promotion square
+		pos.hash_key ^= Tables::PIECE_KEYS[white][promotion][target];
 	}
 	else { // Recover source piece, applies to non promotions
-		piece_bitboards[white][source_piece] &= ~(1ULL << target);
-		hash_key ^= Tables::PIECE_KEYS[white][source_piece][target];
+		removePiece(white, source_piece, 1ULL << target);
+		pos.hash_key ^= Tables::PIECE_KEYS[white][source_piece][target];
+	}
+
+	assert(isOccupancyConsistent());
+	pos.ply_count--;
+}
+
+void Bitboard::applyNullMove(bool white) {
+	// Save state to the search stack, scores don't change
+	UndoInfo& current = search_stack[search_ply].undo;
+	current.castling_rights = pos.castling_rights;
+	current.en_passant_target = pos.en_passant_target;
+	current.flags = pos.state.flags;
+	current.half_moves = pos.half_moves;
+	current.material_delta = 0;
+	current.positional_delta = 0;
+	current.game_phase_delta = 0;
+	saveLegalityData(current); // The mover still generates its own moves after the undo
+
+	// En passant is only possible right after the double push
+	if (pos.en_passant_target != UNASSIGNED) {
+		pos.hash_key ^= Tables::EN_PASSANT_KEYS[pos.en_passant_target % 8];
+		pos.en_passant_target = UNASSIGNED;
+	}
+
+	// Toggle side to move
+	pos.hash_key ^= Tables::SIDE_TO_MOVE_KEY;
+
+	pos.half_moves = 0; // Positions before the null move can't repeat after it
+
+	updateBoardState(white); // Opponent's pins and our attacks, as after a regular move
+
+	search_ply++;
+	pos.ply_count++;
+	key_history[pos.ply_count & KEY_HISTORY_MASK] = pos.hash_key;
+}
+
+void Bitboard::undoNullMove() {
+	search_ply--;
+
+	pos.hash_key ^= Tables::SIDE_TO_MOVE_KEY; // Toggle side to move
+
+	// Restore board state
+	const UndoInfo& prev = search_stack[search_ply].undo;
+	pos.en_passant_target = prev.en_passant_target;
+	pos.state.flags = prev.flags;
+	pos.half_moves = prev.half_moves;
+	restoreLegalityData(prev);
+
+	if (pos.en_passant_target != UNASSIGNED) {
+		pos.hash_key ^= Tables::EN_PASSANT_KEYS[pos.en_passant_target % 8];
 	}
 
-	ply_count--;
+	pos.ply_count--;
+}
+
+void Bitboard::saveLegalityData(UndoInfo& undo) const {
+	undo.blockers_for_king = pos.blockers_for_king;
+	undo.checkers = pos.checkers;
+	undo.attack_squares = pos.attack_squares;
+}
+
+void Bitboard::restoreLegalityData(const UndoInfo& undo) {
+	pos.blockers_for_king = undo.blockers_for_king;
+	pos.checkers = undo.checkers;
+	pos.attack_squares = undo.attack_squares;
+}
+
+int Bitboard::getNonPawnMaterial(bool white) const {
+	return Utils::countSetBits(pos.piece_bitboards[white][KNIGHT]) * PIECE_VALUES[KNIGHT] +
+		Utils::countSetBits(pos.piece_bitboards[white][BISHOP]) * PIECE_VALUES[BISHOP] +
+		Utils::countSetBits(pos.piece_bitboards[white][ROOK]) * PIECE_VALUES[ROOK] +
+		Utils::countSetBits(pos.piece_bitboards[white][QUEEN]) * PIECE_VALUES[QUEEN];
 }
 
 int Bitboard::evaluateBoard() {
 	// Return the total score
-	return material_score + positional_score;
+	return pos.material_score + pos.positional_score;
 }
 
 int Bitboard::evaluateKingSafety() {
-	int white_king = Utils::findFirstSetBit(piece_bitboards[WHITE][KING]);
-	int black_king = Utils::findFirstSetBit(piece_bitboards[BLACK][KING]);
+	int white_king = Utils::findFirstSetBit(pos.piece_bitboards[WHITE][KING]);
+	int black_king = Utils::findFirstSetBit(pos.piece_bitboards[BLACK][KING]);
 
 	int white_penalty = evaluateSingleKingSafety(white_king, true);
 	int black_penalty = evaluateSingleKingSafety(black_king, false);
@@ -1260,20 +1466,18 @@ int Bitboard::evaluateKingSafety() {
 }
 
 bool Bitboard::isGameOver() {
-	return state.isCheckmateWhite() || state.isCheckmateBlack() || state.isDraw();
+	return pos.state.isCheckmateWhite() || pos.state.isCheckmateBlack() || pos.state.isDraw();
 }
 
 bool Bitboard::isDrawByRepetition() {
-	// We use the current hash key 
 	// Current half moves are how many reversible plies back we need to check
+	// Undone plies leave stale keys above ply_count, only the path to the current position is read
+	int reach = std::min({ pos.half_moves, pos.ply_count, KEY_HISTORY_SIZE - 1 });
 	int count = 0;
 
-	// Iterate backwards through the history stack, starting from the parent state.
-	// Check only as far back as the plies since the last irreversible move allows.
-	int current_search_depth = static_cast<int>(search_history.size());
-	for (int i = 1; i <= half_moves && (current_search_depth - i >= 0); ++i) {
-		int history_index = current_search_depth - i;
-		if (search_history[history_index] == hash_key) {
+	// Same side to move only every second ply, and the earliest possible repetition is 4 plies back
+	for (int i = 4; i <= reach; i += 2) {
+		if (key_history[(pos.ply_count - i) & KEY_HISTORY_MASK] == pos.hash_key) {
 			count++;
 			// If we found the same position twice previously in the relevant history,
 			// the current position is the 3rd occurrence.
@@ -1285,10 +1489,43 @@ bool Bitboard::isDrawByRepetition() {
 	return false;
 }
 
+bool Bitboard::hasUpcomingRepetition(bool white) {
+	int reach = std::min({ pos.half_moves, pos.ply_count, KEY_HISTORY_SIZE - 1 });
+	if (reach < 3) return false;
+
+	uint64_t occupied = occupiedSquares();
+	uint64_t own = white ? whitePieces() : blackPieces();
+
+	// Earlier positions with the opponent to move, one of our moves away if the keys differ by a cuckoo entry
+	for (int i = 3; i <= reach; i += 2) {
+		uint64_t earlier_key = key_history[(pos.ply_count - i) & KEY_HISTORY_MASK];
+		uint64_t move_key = pos.hash_key ^ earlier_key;
+
+		int slot = Tables::cuckooSlot1(move_key);
+		if (Tables::CUCKOO_KEYS[slot] != move_key) {
+			slot = Tables::cuckooSlot2(move_key);
+			if (Tables::CUCKOO_KEYS[slot] != move_key) continue;
+		}
+
+		// The piece has to be ours and its path free
+		int sq1 = Tables::CUCKOO_MOVES[slot] & 0x3F;
+		int sq2 = Tables::CUCKOO_MOVES[slot] >> 6;
+		if (Tables::BETWEEN[sq1][sq2] & occupied) continue;
+		int from = (occupied & (1ULL << sq1)) ? sq1 : sq2;
+		if (!(own & (1ULL << from))) continue;
+
+		// The move reaches the earlier position again, a draw if it had already occurred before (threefold)
+		for (int j = i + 2; j <= reach; j += 2) {
+			if (key_history[(pos.ply_count - j) & KEY_HISTORY_MASK] == earlier_key) return true;
+		}
+	}
+	return false;
+}
+
 MoveType Bitboard::getMoveType(int source_square, int target_square, PieceType piece, PieceType target_piece, bool white) const {
 	// Determine move type
 	if (piece == PAWN) {
-		if (target_square == en_passant_target) return EN_PASSANT;
+		if (target_square == pos.en_passant_target) return EN_PASSANT;
 		if ((white && target_square >= 56) || (!white && target_square <= 7)) {
 			return (target_piece == EMPTY) ? PROMOTION : PROMOTION_CAPTURE;
 		}
@@ -1302,34 +1539,34 @@ MoveType Bitboard::getMoveType(int source_square, int target_square, PieceType p
 void Bitboard::undoCastling(bool white, bool kingside) {
 	if (white) {
 		if (kingside) {
-			piece_bitboards[WHITE][ROOK] &= ~ROOK_F1; // Remove rook from f1
-			piece_bitboards[WHITE][ROOK] |= ROOK_H1; // Move rook to h1
+			removePiece(WHITE, ROOK, ROOK_F1); // Remove rook from f1
+			placePiece(WHITE, ROOK, ROOK_H1); // Move rook to h1
 
-			piece_at_square[5] = EMPTY;
-			piece_at_square[7] = ROOK;
+			pos.piece_at_square[5] = EMPTY;
+			pos.piece_at_square[7] = ROOK;
 		}
 		else {
-			piece_bitboards[WHITE][ROOK] &= ~ROOK_D1; // Remove rook from d1
-			piece_bitboards[WHITE][ROOK] |= ROOK_A1; // Move rook to a1
+			removePiece(WHITE, ROOK, ROOK_D1); // Remove rook from d1
+			placePiece(WHITE, ROOK, ROOK_A1); // Move rook to a1
 
-			piece_at_square[3] = EMPTY;
-			piece_at_square[0] = ROOK;
+			pos.piece_at_square[3] = EMPTY;
+			pos.piece_at_square[0] = ROOK;
 		}
 	}
 	else {
 		if (kingside) {
-			piece_bitboards[BLACK][ROOK] &= ~ROOK_F8; // Remove rook from f8
-			piece_bitboards[BLACK][ROOK] |= ROOK_H8; // Move rook to h8
+			removePiece(BLACK, ROOK, ROOK_F8); // Remove rook from f8
+			placePiece(BLACK, ROOK, ROOK_H8); // Move rook to h8
 
-			piece_at_square[61] = EMPTY;
-			piece_at_square[63] = ROOK;
+			pos.piece_at_square[61] = EMPTY;
+			pos.piece_at_square[63] = ROOK;
 		}
 		else {
-			piece_bitboards[BLACK][ROOK] &= ~ROOK_D8; // Remove rook from d8
-			piece_bitboards[BLACK][ROOK] |= ROOK_A8; // Move rook to a8
+			removePiece(BLACK, ROOK, ROOK_D8); // Remove rook from d8
+			placePiece(BLACK, ROOK, ROOK_A8); // Move rook to a8
 
-			piece_at_square[59] = EMPTY;
-			piece_at_square[56] = ROOK;
+			pos.piece_at_square[59] = EMPTY;
+			pos.piece_at_square[56] = ROOK;
 		}
 	}
 }
@@ -1356,7 +1593,7 @@ bool Bitboard::isPassedPawn(int pawn, bool white) {
 	promotion_path |= (file < 7) ? Tables::BETWEEN[white ? (pawn + 9) : (pawn - 7)][final_sq + 1] | (1ULL << (final_sq + 1)) : 0;
 
 	// Get enemy pawns and check if any line up with our mask
-	uint64_t enemy_pawns = white ? piece_bitboards[BLACK][PAWN] : piece_bitboards[WHITE][PAWN];
+	uint64_t enemy_pawns = white ? pos.piece_bitboards[BLACK][PAWN] : pos.piece_bitboards[WHITE][PAWN];
 	return (enemy_pawns & promotion_path) == 0; // No enemy pawns in mask
 }
 
@@ -1372,8 +1609,8 @@ bool Bitboard::isCheckMove(const KingDanger& king_danger, int to, PieceType piec
 int Bitboard::evaluateSingleKingSafety(int king_sq, bool white) {
 	int penalty = 0;
 
-	uint64_t friendly_pawns = piece_bitboards[white][PAWN];
-	uint64_t enemy_pawns = piece_bitboards[!white][PAWN];
+	uint64_t friendly_pawns = pos.piece_bitboards[white][PAWN];
+	uint64_t enemy_pawns = pos.piece_bitboards[!white][PAWN];
 
 	// Define kings file and adjacent files
 	int king_file = king_sq % 8;
@@ -1385,7 +1622,7 @@ int Bitboard::evaluateSingleKingSafety(int king_sq, bool white) {
 	if (!(file_mask & friendly_pawns)) { // File is open or semi-open for the enemy
 		int file_mask_penalty = OPEN_FILE_PENALTY; // Set penalty base
 		// Multiply penalty by heavy piece factor if present
-		if ((file_mask & (piece_bitboards[!white][QUEEN] | piece_bitboards[!white][ROOK])) != 0) {
+		if ((file_mask & (pos.piece_bitboards[!white][QUEEN] | pos.piece_bitboards[!white][ROOK])) != 0) {
 			file_mask_penalty *= HEAVY_PIECE_MULTIPLIER;
 		}
 		// If fully open, slightly higher penalty
@@ -1414,7 +1651,7 @@ int Bitboard::evaluateSingleKingSafety(int king_sq, bool white) {
 	}
 
 	// Penalize pawn storms (enemy pawns near the king)
-	uint64_t storm_zone = MoveTables::KING_MOVES->moves;
+	uint64_t storm_zone = MoveTables::KING_MOVES[0].moves;
 	shield_penalty += Utils::countSetBits(enemy_pawns & storm_zone) * PAWN_STORM_PENALTY;
 
 	penalty += shield_penalty; // Apply shield penalty
@@ -1422,19 +1659,88 @@ int Bitboard::evaluateSingleKingSafety(int king_sq, bool white) {
 	return penalty;
 }
 
-int Bitboard::estimateCaptureValue(uint32_t move) {
-	// Get pieces involved
-	PieceType captured_piece = ChessAI::capturedPiece(move);
-	PieceType attacking_piece = ChessAI::piece(move);
+int Bitboard::staticExchangeEvaluation(uint32_t move) {
+	int from = ChessAI::from(move);
+	int to = ChessAI::to(move);
+	MoveType move_type = ChessAI::moveType(move);
+	PieceType attacker = ChessAI::piece(move); // Piece standing on the target square after each capture
+	PieceType victim = (move_type == EN_PASSANT) ? PAWN : ChessAI::capturedPiece(move);
+	bool white = (pos.piece_bitboards[WHITE][attacker] >> from) & 1ULL;
+
+	uint64_t color_pieces[2] = { blackPieces(), whitePieces() };
+	uint64_t occupied = occupiedSquares();
+	uint64_t bishops_queens = pos.piece_bitboards[WHITE][BISHOP] | pos.piece_bitboards[BLACK][BISHOP] |
+		pos.piece_bitboards[WHITE][QUEEN] | pos.piece_bitboards[BLACK][QUEEN];
+	uint64_t rooks_queens = pos.piece_bitboards[WHITE][ROOK] | pos.piece_bitboards[BLACK][ROOK] |
+		pos.piece_bitboards[WHITE][QUEEN] | pos.piece_bitboards[BLACK][QUEEN];
+
+	// gain[d] = material balance for the side making capture d, if the sequence stopped there
+	int gain[32];
+	int d = 0;
+	gain[0] = (victim == EMPTY) ? 0 : PIECE_VALUES[victim];
+
+	// A promoted pawn is worth the promotion piece, and that is what can be recaptured
+	if (move_type == PROMOTION || move_type == PROMOTION_CAPTURE) {
+		PieceType promotion = ChessAI::promotion(move);
+		gain[0] += PIECE_VALUES[promotion] - PIECE_VALUES[PAWN];
+		attacker = promotion;
+	}
 
-	// Value of captured piece
-	int capture_value = PIECE_VALUES[captured_piece];
+	// En passant victim isn't on the target square
+	if (move_type == EN_PASSANT) {
+		occupied ^= 1ULL << (white ? (to - 8) : (to + 8));
+	}
 
-	// If we're losing the more valuable piece (bad trade)
-	int trade_delta = PIECE_VALUES[attacking_piece] - PIECE_VALUES[captured_piece];
+	uint64_t from_bb = 1ULL << from;
+	uint64_t attackers = attackersTo(to, occupied);
+	bool side = white;
 
-	// Return net gain (could be negative for bad trades)
-	return capture_value - (trade_delta > 0 ? PIECE_VALUES[attacking_piece] : 0);
+	while (true) {
+		d++;
+		gain[d] = PIECE_VALUES[attacker] - gain[d - 1]; // Opponent recaptures the piece on the square, if it can
+
+		// Remove the capturer, sliders lined up behind it now reach the square (x-ray)
+		occupied ^= from_bb;
+		if (attacker == PAWN || attacker == BISHOP || attacker == QUEEN) {
+			attackers |= Moves::getBishopMoves(to, occupied) & bishops_queens;
+		}
+		if (attacker == ROOK || attacker == QUEEN) {
+			attackers |= Moves::getRookMoves(to, occupied) & rooks_queens;
+		}
+		attackers &= occupied;
+
+		// Next capture is made by the other side with its least valuable attacker
+		side = !side;
+		uint64_t side_attackers = attackers & color_pieces[side];
+		if (!side_attackers) break;
+
+		for (int piece = PAWN; piece <= KING; piece++) {
+			uint64_t candidates = side_attackers & pos.piece_bitboards[side][piece];
+			if (candidates) {
+				from_bb = candidates & (~candidates + 1); // Isolate lowest bit
+				attacker = static_cast<PieceType>(piece);
+				break;
+			}
+		}
+	}
+
+	// Negamax the gains back to the first capture, either side may stop capturing
+	while (--d) {
+		gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+	}
+	return gain[0];
+}
+
+uint64_t Bitboard::attackersTo(int square, uint64_t occupied) const {
+	// Pawns attack the square from where a pawn of the other color on it would capture
+	return (Moves::getPawnCaptures(square, false) & pos.piece_bitboards[WHITE][PAWN]) |
+		(Moves::getPawnCaptures(square, true) & pos.piece_bitboards[BLACK][PAWN]) |
+		(Moves::getKnightMoves(square) & (pos.piece_bitboards[WHITE][KNIGHT] | pos.piece_bitboards[BLACK][KNIGHT])) |
+		(Moves::getKingMoves(square) & (pos.piece_bitboards[WHITE][KING] | pos.piece_bitboards[BLACK][KING])) |
+		(Moves::getBishopMoves(square, occupied) & (pos.piece_bitboards[WHITE][BISHOP] | pos.piece_bitboards[BLACK][BISHOP] |
+			pos.piece_bitboards[WHITE][QUEEN] | pos.piece_bitboards[BLACK][QUEEN])) |
+		(Moves::getRookMoves(square, occupied) & (pos.piece_bitboards[WHITE][ROOK] | pos.piece_bitboards[BLACK][ROOK] |
+			pos.piece_bitboards[WHITE][QUEEN] | pos.piece_bitboards[BLACK][QUEEN]));
 }
 
 int Bitboard::estimateEndgameCaptureValue(uint32_t move, bool white) {
@@ -1461,14 +1767,14 @@ int Bitboard::estimateEndgameCaptureValue(uint32_t move, bool white) {
 }
 
 int Bitboard::calculateKingDistance() {
-	int white_king_sq = Utils::findFirstSetBit(piece_bitboards[WHITE][KING]);
-	int black_king_sq = Utils::findFirstSetBit(piece_bitboards[BLACK][KING]);
+	int white_king_sq = Utils::findFirstSetBit(pos.piece_bitboards[WHITE][KING]);
+	int black_king_sq = Utils::findFirstSetBit(pos.piece_bitboards[BLACK][KING]);
 	return Utils::calculateDistance(white_king_sq, black_king_sq);
 }
 
 int Bitboard::getKingCentralization() {
-	int white_king_sq = Utils::findFirstSetBit(piece_bitboards[WHITE][KING]);
-	int black_king_sq = Utils::findFirstSetBit(piece_bitboards[BLACK][KING]);
+	int white_king_sq = Utils::findFirstSetBit(pos.piece_bitboards[WHITE][KING]);
+	int black_king_sq = Utils::findFirstSetBit(pos.piece_bitboards[BLACK][KING]);
 
 	// Calculate both kings distance from center and get diff
 	// If white is closer to center than black -> positive (good for white), and reversed for black
@@ -1476,7 +1782,7 @@ int Bitboard::getKingCentralization() {
 }
 
 int Bitboard::evaluatePassedPawns(bool white) {
-	uint64_t pawns = piece_bitboards[white][PAWN]; // Get friendly pawns
+	uint64_t pawns = pos.piece_bitboards[white][PAWN]; // Get friendly pawns
 	int score = 0;
 
 	while (pawns) {
@@ -1489,12 +1795,12 @@ int Bitboard::evaluatePassedPawns(bool white) {
 		score += (10 + (rank * rank) * 5); // Quadratic scaling
 
 		// Bonus if supported by friendly king
-		int king_sq = Utils::findFirstSetBit(piece_bitboards[white][KING]);
+		int king_sq = Utils::findFirstSetBit(pos.piece_bitboards[white][KING]);
 		int king_dist = Utils::calculateDistance(pawn_sq, king_sq);
 		score += (7 - king_dist) * 10; // Closer king = better
 
 		// Penalty if blocked by enemy king
-		int enemy_king_sq = Utils::findFirstSetBit(piece_bitboards[!white][KING]);
+		int enemy_king_sq = Utils::findFirstSetBit(pos.piece_bitboards[!white][KING]);
 		int enemy_king_dist = Utils::calculateDistance(pawn_sq, enemy_king_sq);
 		if (enemy_king_dist <= 2) score -= 100; // Enemy king can intercept
 		if (king_dist < enemy_king_dist) score += 50; // King is closer than opponent (protecting passed pawn)
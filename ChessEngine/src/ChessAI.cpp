@@ -3,69 +3,232 @@
 #include "Bitboard.hpp"
 #include "Tables.hpp"
 #include "Scoring.hpp"
+#include "SearchThread.hpp"
+#include "MovePicker.hpp"
+
+// Search control
+TimeManager ChessAI::time_manager;
+std::atomic<bool> ChessAI::stop_search{ false };
+SearchStats ChessAI::last_stats;
+
+// Lazy SMP threads
+std::vector<std::unique_ptr<SearchThread>> ChessAI::threads;
+int ChessAI::thread_count = 1;
+bool ChessAI::copy_make = false;
+thread_local SearchThread* ChessAI::current_thread = nullptr;
+
+uint32_t ChessAI::getBestMove(std::unique_ptr<Bitboard>& board, const SearchLimits& limits, bool maximizing) {
+    return iterativeDeepening(board, limits, maximizing, false);
+}
 
+uint32_t ChessAI::getBestEndgameMove(std::unique_ptr<Bitboard>& board, const SearchLimits& limits, bool maximizing) {
+    return iterativeDeepening(board, limits, maximizing, true);
+}
 
-uint32_t ChessAI::getBestMove(std::unique_ptr<Bitboard>& board, int depth, bool maximizing) {
-    std::array<uint32_t, MAX_MOVES> move_list;
+uint32_t ChessAI::iterativeDeepening(std::unique_ptr<Bitboard>& board, const SearchLimits& limits, bool maximizing, bool endgame) {
+    // Start the clock before move generation so the whole call is accounted for
+    time_manager.start(limits);
+    stop_search.store(false, std::memory_order_relaxed);
+    Tables::newSearchTT(); // Entries of earlier searches age from now on
+
+    // The calling thread is the main search thread
+    prepareThreads();
+    SearchThread& main_thread = *threads[0];
+    current_thread = &main_thread;
+    main_thread.stats = SearchStats();
+    main_thread.clearStack();
+    board->startNewSearch(main_thread.stack, copy_make); // Also holds the undo info of the move applied after the search
+
+    // Collect all legal moves for the AI side
+    // Picker order is used as the ordering of the first iteration
+    std::array<RootMove, MAX_MOVES> root_moves;
     int move_count = 0;
-    // Generate all legal moves for the AI side
-    board->generateMoves(move_list, move_count, 0, maximizing, NULL_MOVE_32);
+    MovePicker picker(*board, maximizing, NULL_MOVE, nullptr, 0, endgame);
+    for (uint32_t move = picker.nextMove(); move != NULL_MOVE_32; move = picker.nextMove()) {
+        root_moves[move_count++] = { move, -INF, -INF };
+    }
+
+    // Returns without a search report empty counters, not the ones of the previous search
+    last_stats = SearchStats();
+    last_stats.time_ms = time_manager.elapsed();
 
     if (move_count == 0) {
         return 0; // No legal moves available
     }
 
-    int bestScore = -INF;
-    uint32_t bestMove = 0;
+    // Forced move: nothing to think about when playing on a clock
+    if (move_count == 1 && time_manager.isTimed()) {
+        return root_moves[0].move;
+    }
 
-    board->startNewSearch(); // Clear previous search data
+    // Depth-only searches go to the requested depth, timed searches until the time manager stops them
+    int max_depth = limits.max_depth > 0 ? std::min(limits.max_depth, MAX_ITERATIVE_DEPTH)
+        : (time_manager.isTimed() ? MAX_ITERATIVE_DEPTH : 1);
+
+    // Start the helpers on their own copy of the root position
+    for (size_t i = 1; i < threads.size(); i++) {
+        SearchThread& helper = *threads[i];
+        helper.board = std::make_unique<Bitboard>(*board);
+        helper.board->startNewSearch(helper.stack, copy_make);
+        helper.clearStack();
+        helper.stats = SearchStats();
+        helper.worker = std::thread(helperSearch, std::ref(helper), root_moves, move_count, max_depth, maximizing, endgame);
+    }
 
-    for (int i = 0; i < move_count; i++) {
-        board->applyMoveAI(move_list[i], maximizing);
-        // Negamax: flip perspective by negating recursive result
-        int score = -minimax(board, depth - 1, -INF, INF, !maximizing);
-        board->undoMoveAI(move_list[i], maximizing);
+    uint32_t best_move = searchIterations(main_thread, board, root_moves, move_count, max_depth, maximizing, endgame);
 
-        if (score > bestScore) {
-            bestScore = score;
-            bestMove = move_list[i];
-        }
+    // The main thread decides when the search ends, helpers unwind as soon as they see the flag
+    stop_search.store(true, std::memory_order_relaxed);
+    for (size_t i = 1; i < threads.size(); i++) {
+        threads[i]->worker.join();
+    }
+
+    // Collect the counters of all threads
+    last_stats = main_thread.stats;
+    for (size_t i = 1; i < threads.size(); i++) {
+        last_stats.nodes += threads[i]->stats.nodes;
+        last_stats.zero_window_searches += threads[i]->stats.zero_window_searches;
+        last_stats.researches += threads[i]->stats.researches;
     }
+    last_stats.time_ms = time_manager.elapsed();
 
-    return bestMove;
+    return best_move;
 }
 
-uint32_t ChessAI::getBestEndgameMove(std::unique_ptr<Bitboard>& board, int depth, bool maximizing) {
-    std::array<uint32_t, MAX_MOVES> move_list;
-    int move_count = 0;
-    // Generate all legal endgame moves for the AI side
-    board->generateEndgameMoves(move_list, move_count, 0, maximizing, NULL_MOVE_32);
+uint32_t ChessAI::searchIterations(SearchThread& thread, std::unique_ptr<Bitboard>& board, std::array<RootMove, MAX_MOVES>& root_moves,
+    int move_count, int max_depth, bool maximizing, bool endgame) {
+    uint32_t best_move = root_moves[0].move;
+    int previous_score = 0;
 
-    if (move_count == 0) {
-        return 0;
+    for (int depth = 1; depth <= max_depth; depth++) {
+        // Every other helper searches one ply deeper than the main thread
+        // Threads working on different depths fill the TT with entries the others can use
+        int search_depth = std::min(depth + (thread.id & 1), MAX_ITERATIVE_DEPTH);
+
+        int delta = ASPIRATION_WINDOW;
+        int alpha = -INF;
+        int beta = INF;
+
+        // Open the window around the previous score once the scores have settled
+        if (search_depth >= ASPIRATION_MIN_DEPTH) {
+            alpha = std::max(previous_score - delta, -INF);
+            beta = std::min(previous_score + delta, INF);
+        }
+
+        int score;
+        while (true) {
+            score = searchRoot(board, root_moves, move_count, search_depth, alpha, beta, maximizing, endgame);
+            if (stop_search.load(std::memory_order_relaxed)) break;
+
+            // Widen the failing side of the window and re-search
+            // Once the window has grown past the limit fall back to the full window
+            delta *= 2;
+            if (score <= alpha && alpha > -INF) { // Fail low
+                if (beta < INF) beta = (alpha + beta) / 2; // Pull beta down so a fail-high right after doesn't cost a full re-search
+                alpha = (delta > ASPIRATION_MAX_WINDOW) ? -INF : std::max(score - delta, -INF);
+            }
+            else if (score >= beta && beta < INF) { // Fail high
+                beta = (delta > ASPIRATION_MAX_WINDOW) ? INF : std::min(score + delta, INF);
+            }
+            else {
+                break; // Score is inside the window
+            }
+        }
+
+        // An aborted iteration is discarded, the previous one already picked the move
+        if (stop_search.load(std::memory_order_relaxed)) break;
+
+        previous_score = score;
+        best_move = root_moves[0].move; // searchRoot keeps the best move at the front
+        thread.stats.depth = search_depth;
+
+        // Only the main thread manages the time, helpers run until they are stopped
+        if (thread.id != 0) continue;
+
+        // Decide if another iteration fits in the budget
+        time_manager.updateIteration(best_move, score);
+        if (time_manager.softLimitReached()) break;
     }
 
-    int bestScore = -INF;
-    uint32_t bestMove = 0;
+    return best_move;
+}
+
+void ChessAI::helperSearch(SearchThread& thread, std::array<RootMove, MAX_MOVES> root_moves, int move_count,
+    int max_depth, bool maximizing, bool endgame) {
+    current_thread = &thread;
+    searchIterations(thread, thread.board, root_moves, move_count, max_depth, maximizing, endgame);
+}
 
-    board->startNewSearch();
+int ChessAI::searchRoot(std::unique_ptr<Bitboard>& board, std::array<RootMove, MAX_MOVES>& root_moves, int move_count,
+    int depth, int alpha, int beta, bool maximizing, bool endgame) {
+    int best_score = -INF;
+    int best_index = 0;
 
     for (int i = 0; i < move_count; i++) {
-        board->applyMoveAI(move_list[i], maximizing);
-        int score = -endgameMinimax(board, depth - 1, -INF, INF, !maximizing);
-        board->undoMoveAI(move_list[i], maximizing);
+        RootMove& root_move = root_moves[i];
+        Tables::prefetchTT(board->keyAfter(root_move.move, maximizing));
+        board->applyMoveAI(root_move.move, maximizing);
+        // Negamax: flip perspective by negating recursive result
+        // PVS: only the first move gets the full window
+        int score;
+        if (i == 0) {
+            score = endgame ? -endgameMinimax(board, depth - 1, -beta, -alpha, !maximizing)
+                : -minimax(board, depth - 1, -beta, -alpha, !maximizing);
+        }
+        else {
+            current_thread->stats.zero_window_searches++;
+            score = endgame ? -endgameMinimax(board, depth - 1, -alpha - 1, -alpha, !maximizing)
+                : -minimax(board, depth - 1, -alpha - 1, -alpha, !maximizing);
+            if (score > alpha && score < beta) {
+                current_thread->stats.researches++;
+                score = endgame ? -endgameMinimax(board, depth - 1, -beta, -alpha, !maximizing)
+                    : -minimax(board, depth - 1, -beta, -alpha, !maximizing);
+            }
+        }
 
-        if (score > bestScore) {
-            bestScore = score;
-            bestMove = move_list[i];
+        // Read back the child entry while the move is still applied
+        // The child score orders the remaining moves of the next iteration
+        root_move.tt_score = -INF;
+        TTData entry;
+        if (Tables::probeTT(board->getHashKey(), entry)) {
+            root_move.tt_score = -entry.score;
         }
+        board->undoMoveAI(root_move.move, maximizing);
+
+        if (stop_search.load(std::memory_order_relaxed)) return best_score; // Score is unreliable, keep the old order
+
+        root_move.score = score;
+        if (score > best_score) {
+            best_score = score;
+            if (score > alpha) {
+                alpha = score;
+                best_index = i;
+            }
+        }
+
+        if (alpha >= beta) break; // Fail high, the driver widens the window
+    }
+
+    // Seed the next iteration's ordering: best move first, the rest by their child TT scores
+    // Stable sort keeps the previous relative order for moves without TT information
+    if (best_score > -INF && best_index != 0) {
+        std::rotate(root_moves.begin(), root_moves.begin() + best_index, root_moves.begin() + best_index + 1);
     }
+    std::stable_sort(root_moves.begin() + 1, root_moves.begin() + move_count,
+        [](const RootMove& a, const RootMove& b) { return a.tt_score > b.tt_score; });
 
-    return bestMove;
+    return best_score;
 }
 
+int ChessAI::minimax(std::unique_ptr<Bitboard>& board, int depth, int alpha, int beta, bool maximizing, bool allow_null) {
+    // Unwind immediately once the time is up
+    if (searchStopped()) return 0;
+
+    // No room left on the search stack for another move
+    int ply = board->getSearchPly();
+    if (ply >= MAX_SEARCH_DEPTH) return evaluateBoard(board, maximizing);
+    SearchStack& ss = current_thread->stack[ply];
 
-int ChessAI::minimax(std::unique_ptr<Bitboard>& board, int depth, int alpha, int beta, bool maximizing) {
     // --- Repetition and 50-Move Rule Checks (BEFORE TT Probe/Other Checks) ---
     // Check 50-move rule first (simple counter check)
     if (board->getHalfMoveClock() >= 50) {
@@ -81,115 +244,200 @@ int ChessAI::minimax(std::unique_ptr<Bitboard>& board, int depth, int alpha, int
     // If we have already found a mate score, check if the current depth can possibly improve it.
     // alpha and beta track the best scores found so far. Mate scores are typically large.
     // If alpha is already a mate score found sooner (higher value), don't search deeper if we can't beat it.
-    alpha = std::max(alpha, -MATE_SCORE + board->getPlyCount()); // Adjust alpha based on ply from root
-    beta = std::min(beta, MATE_SCORE - board->getPlyCount());   // Adjust beta based on ply from root
+    alpha = std::max(alpha, -MATE_SCORE + ply); // Adjust alpha based on ply from root
+    beta = std::min(beta, MATE_SCORE - ply);   // Adjust beta based on ply from root
     if (alpha >= beta) {
         return alpha; // Mate distance pruning
     }
 
+    // --- Upcoming Repetition ---
+    // If we can repeat a position with the next move, the node is worth at least a draw
+    if (alpha < 0 && board->hasUpcomingRepetition(maximizing)) {
+        alpha = 0; // Draw score
+        if (alpha >= beta) {
+            return alpha;
+        }
+    }
+
     // --- TT Probe ---
     // --- Transposition Table Probe ---
     uint64_t key = board->getHashKey();
-    uint32_t tt_best_move = NULL_MOVE_32;
+    uint16_t tt_best_move = NULL_MOVE; // Compact, decoded by the move picker
     int original_alpha = alpha; // Store original alpha for TT store flag logic
     bool tt_hit = false;
     int tt_score = -INF; // Initialize with a value indicating no valid score yet
 
-    if (Tables::TT_NUM_ENTRIES > 0) {
-        size_t index = key & Tables::TT_MASK;
-        TTEntry& entry = Tables::TRANSPOSITION_TABLE[index];
-
-        if (entry.zobrist_key_verify == key) { // Check if the entry belongs to the current position
-            tt_hit = true;
-            tt_best_move = entry.best_move; // Use this move first in move ordering
-
-            if (entry.depth >= depth) { // Check if the stored depth is sufficient
-                int stored_score = entry.score;
+    TTData entry;
+    if (Tables::probeTT(key, entry)) { // Check if the entry belongs to the current position
+        tt_hit = true;
+        tt_best_move = entry.best_move; // Use this move first in move ordering
 
-                // Adjust score from mate distance perspective if it's a mate score
-                if (stored_score > MATE_SCORE - MAX_PLY_FROM_MATE) stored_score -= board->getPlyCount();
-                if (stored_score < -MATE_SCORE + MAX_PLY_FROM_MATE) stored_score += board->getPlyCount();
+        if (entry.depth >= depth) { // Check if the stored depth is sufficient
+            // Adjust score from mate distance perspective if it's a mate score
+            int stored_score = scoreFromTT(entry.score, ply);
 
-
-                // Use stored information based on the flag
-                if (entry.flag == FLAG_EXACT) {
-                    return stored_score; // Exact score found
-                }
-                if (entry.flag == FLAG_LOWERBOUND) { // Failed high previously (score >= beta)
-                    if (stored_score >= beta) {
-                        // Update killer move based on TT cutoff before returning
-                        if (!isCapture(tt_best_move) && tt_best_move != NULL_MOVE_32) {
-                            updateKillerMoves(tt_best_move, depth);
-                        }
-                        return stored_score; // This stored lower bound causes a beta cutoff now
+            // Use stored information based on the flag
+            if (entry.flag == FLAG_EXACT) {
+                return stored_score; // Exact score found
+            }
+            if (entry.flag == FLAG_LOWERBOUND) { // Failed high previously (score >= beta)
+                if (stored_score >= beta) {
+                    // Update killer move based on TT cutoff before returning
+                    uint32_t tt_move = board->decodeMove(tt_best_move, maximizing, false);
+                    if (tt_move != NULL_MOVE_32 && !isCapture(tt_move)) {
+                        updateKillerMoves(tt_move, ply);
                     }
-                    alpha = std::max(alpha, stored_score); // Tighten alpha
+                    return stored_score; // This stored lower bound causes a beta cutoff now
                 }
-                else if (entry.flag == FLAG_UPPERBOUND) { // Failed low previously (score <= alpha)
-                    if (stored_score <= alpha) {
-                        // Update killer move based on TT cutoff before returning
-                        if (!isCapture(tt_best_move) && tt_best_move != NULL_MOVE_32) {
-                            updateKillerMoves(tt_best_move, depth);
-                        }
-                        return stored_score; // This stored upper bound causes an alpha cutoff now (fail low)
+                alpha = std::max(alpha, stored_score); // Tighten alpha
+            }
+            else if (entry.flag == FLAG_UPPERBOUND) { // Failed low previously (score <= alpha)
+                if (stored_score <= alpha) {
+                    // Update killer move based on TT cutoff before returning
+                    uint32_t tt_move = board->decodeMove(tt_best_move, maximizing, false);
+                    if (tt_move != NULL_MOVE_32 && !isCapture(tt_move)) {
+                        updateKillerMoves(tt_move, ply);
                     }
-                    beta = std::min(beta, stored_score); // Tighten beta
+                    return stored_score; // This stored upper bound causes an alpha cutoff now (fail low)
                 }
+                beta = std::min(beta, stored_score); // Tighten beta
+            }
 
-                // Check if bounds crossed after tightening
-                if (alpha >= beta) {
-                    // Return the score that caused the cutoff (using alpha as it's a lower bound we achieved)
-                    // Could return stored_score here too depending on exact fail-soft preference
-                    return alpha;
-                }
+            // Check if bounds crossed after tightening
+            if (alpha >= beta) {
+                // Return the score that caused the cutoff (using alpha as it's a lower bound we achieved)
+                // Could return stored_score here too depending on exact fail-soft preference
+                return alpha;
             }
         }
     }
 
-    // --- Base Case: Check for Terminal Nodes or Reached Max Depth ---
-    // Check game over *after* TT probe, as TT might have the result
-    if (board->isGameOver()) {
-        // Ensure evaluateBoard returns score relative to the current player
-        return evaluateBoard(board, depth, maximizing);
-    }
-
+    // --- Base Case: Reached Max Depth ---
+    // Mate and stalemate aren't known yet, the move loop finds them from an empty move list
     // Call Quiescence Search at depth 0
     if (depth <= 0) {
         // Ensure quiescence returns score relative to the current player and uses Negamax
         return quiescence(board, alpha, beta, maximizing);
     }
 
-    // --- Main Negamax Search Logic ---
-    std::array<uint32_t, MAX_MOVES> move_list;
-    int move_count = 0;
-    // Generate moves, potentially using tt_best_move for ordering
-    // The 'maximizing' flag might be needed here if generateMoves depends on it
-    board->generateMoves(move_list, move_count, depth, maximizing, tt_best_move);
+    // --- Frontier Pruning ---
+    // Static eval decides if a shallow non-PV node is worth a full width search
+    // Never in check (evasions must be searched) or around mate scores
+    bool in_check = maximizing ? board->getState().isCheckWhite() : board->getState().isCheckBlack();
+    bool pv_node = beta - alpha > 1;
+    bool can_prune = !pv_node && !in_check &&
+        alpha > -MATE_SCORE + MAX_PLY_FROM_MATE && beta < MATE_SCORE - MAX_PLY_FROM_MATE;
+    int static_eval = can_prune ? evaluateBoard(board, maximizing) : 0;
+    int tt_eval = can_prune ? static_eval : TT_NO_EVAL; // Kept in the TT entry of the node
+    ss.static_eval = static_eval;
+
+    // Reverse futility pruning (static null move)
+    // Eval is so far above beta that losing a margin per ply still fails high
+    if (can_prune && depth <= RFP_MAX_DEPTH && static_eval - RFP_MARGIN * depth >= beta) {
+        return beta;
+    }
 
-    // Check if no legal moves (Stalemate or Checkmate handled by isGameOver, but as safeguard)
-    if (move_count == 0) {
-        // If no moves but not game over (shouldn't happen with correct isGameOver) -> Draw?
-        // Or evaluate should handle mate/stalemate based on check status
-        return evaluateBoard(board, depth, maximizing);
+    // Razoring
+    // Eval is so far below alpha that only captures could save the node, let quiescence confirm it
+    if (can_prune && depth <= RAZOR_MAX_DEPTH && static_eval + RAZOR_MARGINS[depth] <= alpha) {
+        int razor_score = quiescence(board, alpha, alpha + 1, maximizing);
+        if (stop_search.load(std::memory_order_relaxed)) return 0;
+        if (razor_score <= alpha) return alpha;
+    }
+
+    // --- Null Move Pruning ---
+    // Pass the turn: if the opponent can't even punish a free move with a reduced search, our position is good enough to cut
+    // Not in PV nodes, in check, right after another null move, or with only pawns left (zugzwang)
+    if (can_prune && allow_null && depth >= NULL_MOVE_MIN_DEPTH && static_eval >= beta &&
+        board->getNonPawnMaterial(maximizing) > 0) {
+        int reduction = nullMoveReduction(depth, static_eval, beta);
+
+        ss.current_move = NULL_MOVE_32;
+        board->applyNullMove(maximizing);
+        int null_score = -minimax(board, std::max(depth - 1 - reduction, 0), -beta, -beta + 1, !maximizing, false);
+        board->undoNullMove();
+
+        if (stop_search.load(std::memory_order_relaxed)) return 0;
+
+        if (null_score >= beta) {
+            return beta; // Fail high, a mate found after passing isn't a real mate either
+        }
     }
 
+    // Futility pruning
+    // Quiet moves can't lift a frontier node this far below alpha, only the first move and tactical moves are searched
+    // Checks are told apart before the move is made, so pruned moves skip the make and unmake
+    bool futile = can_prune && depth <= FUTILITY_MAX_DEPTH && static_eval + FUTILITY_MARGINS[depth] <= alpha;
+    KingDanger check_squares = {};
+    uint64_t discovered_checkers = 0ULL;
+    if (futile) {
+        check_squares = board->getCheckSquares(maximizing);
+        discovered_checkers = board->getDiscoveredCheckers(maximizing);
+    }
+
+    // --- Main Negamax Search Logic ---
+    // Moves come from the staged picker: TT move, good captures, killers, quiets, bad captures
+    // Later stages are only generated if no earlier move cuts the node
+    MovePicker picker(*board, maximizing, tt_best_move, ss.killers, depth, false);
+    int move_count = 0; // Moves handed out so far
 
     int best_eval = -INF; // Best score found so far for the current player
     uint32_t best_move_found = NULL_MOVE_32; // Track best move at this node
     TTFlag flag = FLAG_UPPERBOUND; // Assume fail-low initially (score <= original_alpha)
 
     // --- Iterate Through Moves ---
-    for (int i = 0; i < move_count; i++) {
+    for (uint32_t move = picker.nextMove(); move != NULL_MOVE_32; move = picker.nextMove()) {
+        int i = move_count++; // Index of the move in the ordering
+
+        if (futile && i > 0 && !isCapture(move) && !isPromotion(move) &&
+            !board->givesCheck(move, check_squares, discovered_checkers, maximizing)) {
+            continue;
+        }
+
         // Apply the move
         // 'maximizing' might be needed if apply/undo depend on it
-        board->applyMoveAI(move_list[i], maximizing);
+        ss.current_move = move;
+        Tables::prefetchTT(board->keyAfter(move, maximizing)); // Child probes its TT cluster first, load it while the move is applied
+        board->applyMoveAI(move, maximizing);
+
+        // --- Principal Variation Search ---
+        // The first move is expected to be the best one (TT move, MVV-LVA) and gets the full window
+        // The rest only have to prove they can't beat alpha, which a null window does much cheaper
+        int eval;
+        if (i == 0) {
+            // Recursive Negamax call: negate result, swap & negate bounds
+            eval = -minimax(board, depth - 1, -beta, -alpha, !maximizing);
+        }
+        else {
+            // --- Late Move Reductions ---
+            // Quiet moves late in the ordered list rarely raise alpha, search them shallower
+            int reduction = 0;
+            if (depth >= LMR_MIN_DEPTH && i >= LMR_MIN_MOVE_INDEX && !in_check &&
+                !isCapture(move) && !isPromotion(move)) {
+                bool gives_check = maximizing ? board->getState().isCheckBlack() : board->getState().isCheckWhite();
+                reduction = lateMoveReduction(move, depth, ply, i, gives_check);
+            }
 
-        // Recursive Negamax call: negate result, swap & negate bounds
-        int eval = -minimax(board, depth - 1, -beta, -alpha, !maximizing);
+            current_thread->stats.zero_window_searches++;
+            eval = -minimax(board, depth - 1 - reduction, -alpha - 1, -alpha, !maximizing);
+
+            // The reduced search beat alpha, don't trust it before a full depth search agrees
+            if (reduction > 0 && eval > alpha) {
+                eval = -minimax(board, depth - 1, -alpha - 1, -alpha, !maximizing);
+            }
+
+            // Failed high inside the window: the move might be the new best, get its exact score
+            if (eval > alpha && eval < beta) {
+                current_thread->stats.researches++;
+                eval = -minimax(board, depth - 1, -beta, -alpha, !maximizing);
+            }
+        }
 
         // Undo the move
-        board->undoMoveAI(move_list[i], maximizing);
+        board->undoMoveAI(move, maximizing);
 
+        // Aborted subtree, don't let its score reach alpha or the TT
+        if (stop_search.load(std::memory_order_relaxed)) return 0;
 
         // --- Update Best Score and Alpha ---
         if (eval > best_eval) {
@@ -197,12 +445,12 @@ int ChessAI::minimax(std::unique_ptr<Bitboard>& board, int depth, int alpha, int
 
             if (best_eval > alpha) {
                 alpha = best_eval; // Raise the lower bound (best score guaranteed for current player)
-                best_move_found = move_list[i]; // This is currently the best move
+                best_move_found = move; // This is currently the best move
                 flag = FLAG_EXACT; // Score is potentially exact (within original alpha-beta window)
 
                 // Update history heuristic for non-captures that improve alpha
-                if (!isCapture(move_list[i])) {
-                    updateHistory(move_list[i], depth);
+                if (!isCapture(move)) {
+                    updateHistory(move, depth);
                 }
             }
         }
@@ -212,60 +460,31 @@ int ChessAI::minimax(std::unique_ptr<Bitboard>& board, int depth, int alpha, int
         // The current player's score is guaranteed to be at least beta.
         if (alpha >= beta) {
             // Store killer move *before* storing TT entry (only non-captures)
-            if (!isCapture(move_list[i])) {
-                updateKillerMoves(move_list[i], depth);
+            if (!isCapture(move)) {
+                updateKillerMoves(move, ply);
             }
 
             flag = FLAG_LOWERBOUND; // Indicates the score is at least beta (failed high)
             best_eval = beta; // Return the cutoff bound score (fail-soft)
 
             // --- TT Store on Beta Cutoff ---
-            if (Tables::TT_NUM_ENTRIES > 0) {
-                size_t index = key & Tables::TT_MASK;
-                // Store only if entry is empty, shallower, or same depth (preference)
-                if (Tables::TRANSPOSITION_TABLE[index].depth <= depth || Tables::TRANSPOSITION_TABLE[index].zobrist_key_verify != key) {
-                    TTEntry& entry_to_store = Tables::TRANSPOSITION_TABLE[index];
-                    entry_to_store.zobrist_key_verify = key;
-                    // Adjust score for mate distance before storing
-                    int store_score = best_eval;
-                    if (store_score > MATE_SCORE - MAX_PLY_FROM_MATE) store_score += board->getPlyCount(); // Store relative to root
-
-                    entry_to_store.score = (int16_t)std::clamp(store_score, -32767, 32767);
-                    entry_to_store.depth = (int8_t)depth;
-                    entry_to_store.flag = flag; // FLAG_LOWERBOUND
-                    entry_to_store.best_move = move_list[i]; // Store the move causing cutoff
-                }
-            }
+            // Adjust score for mate distance before storing, store the move causing cutoff
+            Tables::storeTT(key, compactMove(move), scoreToTT(best_eval, ply), tt_eval, depth, flag);
             return best_eval; // Prune the rest of the moves at this node
         }
     } // End of move loop
 
+    // No legal moves: checkmate if in check, otherwise stalemate
+    if (move_count == 0) {
+        return in_check ? -MATE_SCORE + ply : 0;
+    }
+
     // --- Final TT Store (if no cutoff occurred) ---
     // We explored all moves and didn't get a beta cutoff.
     // The best score found is 'alpha' (if it improved) or the initial 'best_eval' (if it didn't raise alpha).
     // The flag is either FLAG_EXACT (if alpha > original_alpha) or FLAG_UPPERBOUND (if alpha <= original_alpha).
-    if (Tables::TT_NUM_ENTRIES > 0) {
-        size_t index = key & Tables::TT_MASK;
-        // Store only if entry is empty, shallower, or same depth and better flag (Exact > Bounds)
-        bool should_replace = Tables::TRANSPOSITION_TABLE[index].zobrist_key_verify != key ||
-            Tables::TRANSPOSITION_TABLE[index].depth < depth ||
-            (Tables::TRANSPOSITION_TABLE[index].depth == depth && flag == FLAG_EXACT && Tables::TRANSPOSITION_TABLE[index].flag != FLAG_EXACT);
-
-        if (should_replace) {
-            TTEntry& entry_to_store = Tables::TRANSPOSITION_TABLE[index];
-            entry_to_store.zobrist_key_verify = key;
-            // Adjust score for mate distance before storing
-            int store_score = alpha; // alpha holds the best score found within the bounds
-            if (store_score > MATE_SCORE - MAX_PLY_FROM_MATE) store_score += board->getPlyCount(); // Store relative to root
-            if (store_score < -MATE_SCORE + MAX_PLY_FROM_MATE) store_score -= board->getPlyCount(); // Store relative to root
-
-
-            entry_to_store.score = (int16_t)std::clamp(store_score, -32767, 32767);
-            entry_to_store.depth = (int8_t)depth;
-            entry_to_store.flag = flag; // Will be FLAG_EXACT or FLAG_UPPERBOUND
-            entry_to_store.best_move = best_move_found; // Store the best move found
-        }
-    }
+    // alpha holds the best score found within the bounds, adjusted for mate distance before storing
+    Tables::storeTT(key, compactMove(best_move_found), scoreToTT(alpha, ply), tt_eval, depth, flag);
 
     // Return the best score found for the current player within the alpha-beta bounds
     // In Negamax fail-soft, this is typically 'alpha'.
@@ -273,6 +492,14 @@ int ChessAI::minimax(std::unique_ptr<Bitboard>& board, int depth, int alpha, int
 }
 
 int ChessAI::quiescence(std::unique_ptr<Bitboard>& board, int alpha, int beta, bool maximizing) {
+    // Unwind immediately once the time is up
+    if (searchStopped()) return 0;
+
+    // No room left on the search stack for another move
+    int ply = board->getSearchPly();
+    if (ply >= MAX_SEARCH_DEPTH) return evaluateBoard(board, maximizing);
+    SearchStack& ss = current_thread->stack[ply];
+
     // --- Repetition and 50-Move Rule Checks (BEFORE TT Probe/Other Checks) ---
     // Check 50-move rule first (simple counter check)
     if (board->getHalfMoveClock() >= 50) {
@@ -284,30 +511,44 @@ int ChessAI::quiescence(std::unique_ptr<Bitboard>& board, int alpha, int beta, b
         return 0; // Draw score
     }
 
-    int eval = evaluateBoard(board, 0, maximizing);  // Get a static evaluation of the current position
+    // Only captures are generated here, so a mate is looked for separately when in check
+    // Stalemates are left to the main search
+    bool in_check = maximizing ? board->getState().isCheckWhite() : board->getState().isCheckBlack();
+    if (in_check && !board->hasLegalMoves(maximizing)) {
+        return -MATE_SCORE + ply;
+    }
+
+    int eval = evaluateBoard(board, maximizing);  // Get a static evaluation of the current position
+    ss.static_eval = eval;
 
     // Stand pat: if this position is already better than beta, cut off search (pruning)
     if (eval >= beta) return beta;
     if (eval > alpha) alpha = eval;  // Update alpha if we find a better move
 
-    // Generate captures + promotions (non quiet moves)
-    std::array<uint32_t, MAX_MOVES> move_list;
-    int move_count = 0;
-    board->generateNoisyMoves(move_list, move_count, maximizing);
+    // Captures + promotions (non quiet moves), losing captures last
+    MovePicker picker(*board, maximizing, false);
 
-    for (int i = 0; i < move_count; i++) {
-        int move_value = board->estimateCaptureValue(move_list[i]);
+    for (uint32_t move = picker.nextMove(); move != NULL_MOVE_32; move = picker.nextMove()) {
+        // Promotions are always searched
+        if (!isPromotion(move)) {
+            int move_value = board->staticExchangeEvaluation(move);
 
-        // Delta pruning - skip moves that can't possibly raise alpha
-        // Skip delta pruning for all promotions
-        if (!isPromotion(move_list[i]) && eval + move_value + DELTA_MARGIN_MIDGAME <= alpha) {
-            continue; // Skip this move as it can't improve alpha
+            // SEE pruning - a capture losing material can't beat standing pat
+            if (move_value < 0) continue;
+
+            // Delta pruning - skip moves that can't possibly raise alpha
+            if (eval + move_value + DELTA_MARGIN_MIDGAME <= alpha) {
+                continue; // Skip this move as it can't improve alpha
+            }
         }
-        board->applyMoveAI(move_list[i], maximizing);
+        ss.current_move = move;
+        board->applyMoveAI(move, maximizing);
 
         int score = -quiescence(board, -beta, -alpha, !maximizing);  // Negamax approach
 
-        board->undoMoveAI(move_list[i], maximizing);
+        board->undoMoveAI(move, maximizing);
+
+        if (stop_search.load(std::memory_order_relaxed)) return 0;
 
         if (score >= beta) return beta;  // Beta cutoff
         if (score > alpha) alpha = score;  // Improve alpha
@@ -317,26 +558,28 @@ int ChessAI::quiescence(std::unique_ptr<Bitboard>& board, int alpha, int beta, b
 }
 
 
-int ChessAI::evaluateBoard(std::unique_ptr<Bitboard>& board, int depth, bool maximizing) {
-    int score = 0;
-    if (board->state.isCheckmateWhite()) score = -MATE_SCORE + (depth * 1000);  // White loses
-	else if (board->state.isCheckmateBlack()) score = MATE_SCORE - (depth * 1000); // Black loses
-    else if (board->state.isStalemate()) score = 0; // Draw -> neutral outcome
-    else {
-        score = board->evaluateBoard(); // Material+positional score relative to white
-        // King safety evaluation for both sides
-        // Acts as a penalty more than a bonus
-        score -= static_cast<int>(board->evaluateKingSafety() * KING_SAFETY_WEIGHT);
-        // Encourage attacking the opponents king
-        if (board->state.isCheckWhite()) score -= 50; // White in check
-        if (board->state.isCheckBlack()) score += 50; // Black in check
-    }
+int ChessAI::evaluateBoard(std::unique_ptr<Bitboard>& board, bool maximizing) {
+    int score = board->evaluateBoard(); // Material+positional score relative to white
+    // King safety evaluation for both sides
+    // Acts as a penalty more than a bonus
+    score -= static_cast<int>(board->evaluateKingSafety() * KING_SAFETY_WEIGHT);
+    // Encourage attacking the opponents king
+    if (board->getState().isCheckWhite()) score -= 50; // White in check
+    if (board->getState().isCheckBlack()) score += 50; // Black in check
 
     // Return the score (negate for black)
     return maximizing ? score : -score;
 }
 
-int ChessAI::endgameMinimax(std::unique_ptr<Bitboard>& board, int depth, int alpha, int beta, bool maximizing) {
+int ChessAI::endgameMinimax(std::unique_ptr<Bitboard>& board, int depth, int alpha, int beta, bool maximizing, bool allow_null) {
+    // Unwind immediately once the time is up
+    if (searchStopped()) return 0;
+
+    // No room left on the search stack for another move
+    int ply = board->getSearchPly();
+    if (ply >= MAX_SEARCH_DEPTH) return evaluateEndgameBoard(board, maximizing);
+    SearchStack& ss = current_thread->stack[ply];
+
     // --- Repetition and 50-Move Rule Checks (BEFORE TT Probe/Other Checks) ---
     if (board->getHalfMoveClock() >= 50) {
         return 0; // Draw score
@@ -347,101 +590,144 @@ int ChessAI::endgameMinimax(std::unique_ptr<Bitboard>& board, int depth, int alp
     }
 
     // --- Mate Distance Pruning ---
-    alpha = std::max(alpha, -MATE_SCORE + board->getPlyCount()); // Adjust alpha based on ply from root
-    beta = std::min(beta, MATE_SCORE - board->getPlyCount());   // Adjust beta based on ply from root
+    alpha = std::max(alpha, -MATE_SCORE + ply); // Adjust alpha based on ply from root
+    beta = std::min(beta, MATE_SCORE - ply);   // Adjust beta based on ply from root
     if (alpha >= beta) {
         return alpha; // Mate distance pruning
     }
 
+    // --- Upcoming Repetition ---
+    // If we can repeat a position with the next move, the node is worth at least a draw
+    if (alpha < 0 && board->hasUpcomingRepetition(maximizing)) {
+        alpha = 0; // Draw score
+        if (alpha >= beta) {
+            return alpha;
+        }
+    }
+
     // --- TT Probe ---
     // --- Transposition Table Probe ---
     uint64_t key = board->getHashKey();
-    uint32_t tt_best_move = NULL_MOVE_32;
+    uint16_t tt_best_move = NULL_MOVE; // Compact, decoded by the move picker
     int original_alpha = alpha;
     bool tt_hit = false;
     int tt_score = -INF; 
 
-    if (Tables::TT_NUM_ENTRIES > 0) {
-        size_t index = key & Tables::TT_MASK;
-        TTEntry& entry = Tables::TRANSPOSITION_TABLE[index];
+    TTData entry;
+    if (Tables::probeTT(key, entry)) {
+        tt_hit = true;
+        tt_best_move = entry.best_move; 
 
-        if (entry.zobrist_key_verify == key) {
-            tt_hit = true;
-            tt_best_move = entry.best_move; 
+        if (entry.depth >= depth) {
+            int stored_score = scoreFromTT(entry.score, ply);
 
-            if (entry.depth >= depth) {
-                int stored_score = entry.score;
-
-                if (stored_score > MATE_SCORE - MAX_PLY_FROM_MATE) stored_score -= board->getPlyCount();
-                if (stored_score < -MATE_SCORE + MAX_PLY_FROM_MATE) stored_score += board->getPlyCount();
-
-
-                if (entry.flag == FLAG_EXACT) {
-                    return stored_score; 
-                }
-                if (entry.flag == FLAG_LOWERBOUND) {
-                    if (stored_score >= beta) {
-                        if (!isCapture(tt_best_move) && tt_best_move != NULL_MOVE_32) {
-                            updateKillerMoves(tt_best_move, depth);
-                        }
-                        return stored_score;
+            if (entry.flag == FLAG_EXACT) {
+                return stored_score; 
+            }
+            if (entry.flag == FLAG_LOWERBOUND) {
+                if (stored_score >= beta) {
+                    uint32_t tt_move = board->decodeMove(tt_best_move, maximizing, false);
+                    if (tt_move != NULL_MOVE_32 && !isCapture(tt_move)) {
+                        updateKillerMoves(tt_move, ply);
                     }
-                    alpha = std::max(alpha, stored_score);
+                    return stored_score;
                 }
-                else if (entry.flag == FLAG_UPPERBOUND) {
-                    if (stored_score <= alpha) {
-                        if (!isCapture(tt_best_move) && tt_best_move != NULL_MOVE_32) {
-                            updateKillerMoves(tt_best_move, depth);
-                        }
-                        return stored_score;
+                alpha = std::max(alpha, stored_score);
+            }
+            else if (entry.flag == FLAG_UPPERBOUND) {
+                if (stored_score <= alpha) {
+                    uint32_t tt_move = board->decodeMove(tt_best_move, maximizing, false);
+                    if (tt_move != NULL_MOVE_32 && !isCapture(tt_move)) {
+                        updateKillerMoves(tt_move, ply);
                     }
-                    beta = std::min(beta, stored_score);
+                    return stored_score;
                 }
+                beta = std::min(beta, stored_score);
+            }
 
-                if (alpha >= beta) {
-                    return alpha;
-                }
+            if (alpha >= beta) {
+                return alpha;
             }
         }
     }
 
-    // --- Base Case: Check for Terminal Nodes or Reached Max Depth ---
-    if (board->isGameOver()) {
-        return evaluateEndgameBoard(board, depth, maximizing);
-    }
-
+    // --- Base Case: Reached Max Depth ---
+    // Mate and stalemate aren't known yet, the move loop finds them from an empty move list
     // Call Quiescence Search at depth 0
     if (depth <= 0) {
         return endgameQuiescence(board, alpha, beta, maximizing);
     }
 
+    // --- Null Move Pruning ---
+    // Zugzwang is common in the endgame: disabled with only pawns left,
+    // and with few pieces a null move cutoff must be confirmed by a reduced search without null moves
+    bool in_check = maximizing ? board->getState().isCheckWhite() : board->getState().isCheckBlack();
+    int non_pawn_material = board->getNonPawnMaterial(maximizing);
+    int tt_eval = TT_NO_EVAL;
+    if (allow_null && !in_check && depth >= NULL_MOVE_MIN_DEPTH && beta - alpha == 1 &&
+        beta < MATE_SCORE - MAX_PLY_FROM_MATE && non_pawn_material > 0) {
+        int static_eval = evaluateEndgameBoard(board, maximizing);
+        tt_eval = static_eval;
+        ss.static_eval = static_eval;
+        if (static_eval >= beta) {
+            int reduction = nullMoveReduction(depth, static_eval, beta);
+
+            ss.current_move = NULL_MOVE_32;
+            board->applyNullMove(maximizing);
+            int null_score = -endgameMinimax(board, std::max(depth - 1 - reduction, 0), -beta, -beta + 1, !maximizing, false);
+            board->undoNullMove();
+
+            if (stop_search.load(std::memory_order_relaxed)) return 0;
+
+            if (null_score >= beta) {
+                if (non_pawn_material > NULL_MOVE_VERIFY_MATERIAL) return beta;
+
+                // Verification search: a real move has to hold beta as well
+                int verify_score = endgameMinimax(board, std::max(depth - reduction, 0), beta - 1, beta, maximizing, false);
+                if (stop_search.load(std::memory_order_relaxed)) return 0;
+                if (verify_score >= beta) return beta;
+            }
+        }
+    }
+
     // Check extension: Extend if current player is in check
-    if (maximizing ? board->state.isCheckBlack() : board->state.isCheckWhite()) {
+    if (maximizing ? board->getState().isCheckBlack() : board->getState().isCheckWhite()) {
         depth += 1; // Standard extension
     }
 
     // --- Main Negamax Search Logic ---
-    std::array<uint32_t, MAX_MOVES> move_list;
+    // TT move first, then the endgame ordering
+    MovePicker picker(*board, maximizing, tt_best_move, nullptr, depth, true);
     int move_count = 0;
-    board->generateEndgameMoves(move_list, move_count, depth, maximizing, tt_best_move);
-
-    // Check if no legal moves (Stalemate or Checkmate handled by isGameOver, but as safeguard)
-    if (move_count == 0) {
-        return evaluateEndgameBoard(board, depth, maximizing);
-    }
-
 
     int best_eval = -INF; 
     uint32_t best_move_found = NULL_MOVE_32; 
     TTFlag flag = FLAG_UPPERBOUND; 
 
     // --- Iterate Through Moves ---
-    for (int i = 0; i < move_count; i++) {
-        board->applyMoveAI(move_list[i], maximizing);
+    for (uint32_t move = picker.nextMove(); move != NULL_MOVE_32; move = picker.nextMove()) {
+        int i = move_count++;
+        ss.current_move = move;
+        Tables::prefetchTT(board->keyAfter(move, maximizing));
+        board->applyMoveAI(move, maximizing);
+
+        // Principal variation search, same as in midgame
+        int eval;
+        if (i == 0) {
+            eval = -endgameMinimax(board, depth - 1, -beta, -alpha, !maximizing);
+        }
+        else {
+            current_thread->stats.zero_window_searches++;
+            eval = -endgameMinimax(board, depth - 1, -alpha - 1, -alpha, !maximizing);
+            if (eval > alpha && eval < beta) {
+                current_thread->stats.researches++;
+                eval = -endgameMinimax(board, depth - 1, -beta, -alpha, !maximizing);
+            }
+        }
 
-        int eval = -endgameMinimax(board, depth - 1, -beta, -alpha, !maximizing);
+        board->undoMoveAI(move, maximizing);
 
-        board->undoMoveAI(move_list[i], maximizing);
+        if (stop_search.load(std::memory_order_relaxed)) return 0;
 
         // --- Update Best Score and Alpha ---
         if (eval > best_eval) {
@@ -449,71 +735,50 @@ int ChessAI::endgameMinimax(std::unique_ptr<Bitboard>& board, int depth, int alp
 
             if (best_eval > alpha) {
                 alpha = best_eval; 
-                best_move_found = move_list[i];
+                best_move_found = move;
                 flag = FLAG_EXACT; 
 
-                if (!isCapture(move_list[i])) {
-                    updateHistory(move_list[i], depth);
+                if (!isCapture(move)) {
+                    updateHistory(move, depth);
                 }
             }
         }
 
         // --- Beta Cutoff Check (Fail High) ---
         if (alpha >= beta) {
-            if (!isCapture(move_list[i])) {
-                updateKillerMoves(move_list[i], depth);
+            if (!isCapture(move)) {
+                updateKillerMoves(move, ply);
             }
 
             flag = FLAG_LOWERBOUND; 
             best_eval = beta; 
 
             // --- TT Store on Beta Cutoff ---
-            if (Tables::TT_NUM_ENTRIES > 0) {
-                size_t index = key & Tables::TT_MASK;
-                if (Tables::TRANSPOSITION_TABLE[index].depth <= depth || Tables::TRANSPOSITION_TABLE[index].zobrist_key_verify != key) {
-                    TTEntry& entry_to_store = Tables::TRANSPOSITION_TABLE[index];
-                    entry_to_store.zobrist_key_verify = key;
-
-                    int store_score = best_eval;
-                    if (store_score > MATE_SCORE - MAX_PLY_FROM_MATE) store_score += board->getPlyCount(); 
-
-                    entry_to_store.score = (int16_t)std::clamp(store_score, -32767, 32767);
-                    entry_to_store.depth = (int8_t)depth;
-                    entry_to_store.flag = flag;
-                    entry_to_store.best_move = move_list[i]; 
-                }
-            }
+            Tables::storeTT(key, compactMove(move), scoreToTT(best_eval, ply), tt_eval, depth, flag);
             return best_eval; // Prune the rest of the moves at this node
         }
     } // End of move loop
 
-    // --- Final TT Store (if no cutoff occurred) ---
-    if (Tables::TT_NUM_ENTRIES > 0) {
-        size_t index = key & Tables::TT_MASK;
-        bool should_replace = Tables::TRANSPOSITION_TABLE[index].zobrist_key_verify != key ||
-            Tables::TRANSPOSITION_TABLE[index].depth < depth ||
-            (Tables::TRANSPOSITION_TABLE[index].depth == depth && flag == FLAG_EXACT && Tables::TRANSPOSITION_TABLE[index].flag != FLAG_EXACT);
-
-        if (should_replace) {
-            TTEntry& entry_to_store = Tables::TRANSPOSITION_TABLE[index];
-            entry_to_store.zobrist_key_verify = key;
-
-            int store_score = alpha; 
-            if (store_score > MATE_SCORE - MAX_PLY_FROM_MATE) store_score += board->getPlyCount(); 
-            if (store_score < -MATE_SCORE + MAX_PLY_FROM_MATE) store_score -= board->getPlyCount(); 
-
-
-            entry_to_store.score = (int16_t)std::clamp(store_score, -32767, 32767);
-            entry_to_store.depth = (int8_t)depth;
-            entry_to_store.flag = flag; 
-            entry_to_store.best_move = best_move_found; 
-        }
+    // No legal moves: checkmate if in check, otherwise stalemate
+    if (move_count == 0) {
+        return in_check ? -MATE_SCORE + ply : 0;
     }
 
+    // --- Final TT Store (if no cutoff occurred) ---
+    Tables::storeTT(key, compactMove(best_move_found), scoreToTT(alpha, ply), tt_eval, depth, flag);
+
     return alpha;
 }
 
 int ChessAI::endgameQuiescence(std::unique_ptr<Bitboard>& board, int alpha, int beta, bool maximizing) {
+    // Unwind immediately once the time is up
+    if (searchStopped()) return 0;
+
+    // No room left on the search stack for another move
+    int ply = board->getSearchPly();
+    if (ply >= MAX_SEARCH_DEPTH) return evaluateEndgameBoard(board, maximizing);
+    SearchStack& ss = current_thread->stack[ply];
+
     // --- Repetition and 50-Move Rule Checks (BEFORE TT Probe/Other Checks) ---
     if (board->getHalfMoveClock() >= 50) {
         return 0; // Draw score
@@ -523,30 +788,44 @@ int ChessAI::endgameQuiescence(std::unique_ptr<Bitboard>& board, int alpha, int
         return 0; // Draw score
     }
 
-    int eval = evaluateEndgameBoard(board, 0, maximizing);  // Get a static evaluation of the current position
+    // Only noisy moves are generated here, so a mate is looked for separately when in check
+    // Stalemates are left to the main search
+    bool in_check = maximizing ? board->getState().isCheckWhite() : board->getState().isCheckBlack();
+    if (in_check && !board->hasLegalMoves(maximizing)) {
+        return -MATE_SCORE + ply;
+    }
+
+    int eval = evaluateEndgameBoard(board, maximizing);  // Get a static evaluation of the current position
+    ss.static_eval = eval;
 
     // Stand pat: if this position is already better than beta, cut off search (pruning)
     if (eval >= beta) return beta;
     if (eval > alpha) alpha = eval;  // Update alpha if we find a better move
 
-    // Generate captures + promotions (non quiet moves)
-    std::array<uint32_t, MAX_MOVES> move_list;
-    int move_count = 0;
-    board->generateEndgameNoisyMoves(move_list, move_count, maximizing);
+    // Captures, promotions and checks
+    MovePicker picker(*board, maximizing, true);
 
-    for (int i = 0; i < move_count; i++) {
-        int move_value = board->estimateCaptureValue(move_list[i]);
+    for (uint32_t move = picker.nextMove(); move != NULL_MOVE_32; move = picker.nextMove()) {
+        // Promotions and checks are always searched
+        if (!isPromotion(move) && !isCheck(move)) {
+            int move_value = board->staticExchangeEvaluation(move);
+
+            // SEE pruning - a capture losing material can't beat standing pat
+            if (move_value < 0) continue;
 
-        // Delta pruning - skip moves that can't possibly raise alpha
-        // Skip delta pruning for all promotions and checks
-        if (!isPromotion(move_list[i]) && !isCheck(move_list[i]) && eval + move_value + DELTA_MARGIN_ENDGAME <= alpha) {
-            continue; // Skip this move as it can't improve alpha
+            // Delta pruning - skip moves that can't possibly raise alpha
+            if (eval + move_value + DELTA_MARGIN_ENDGAME <= alpha) {
+                continue; // Skip this move as it can't improve alpha
+            }
         }
-        board->applyMoveAI(move_list[i], maximizing);
+        ss.current_move = move;
+        board->applyMoveAI(move, maximizing);
 
         int score = -endgameQuiescence(board, -beta, -alpha, !maximizing);  // Negamax approach
 
-        board->undoMoveAI(move_list[i], maximizing);
+        board->undoMoveAI(move, maximizing);
+
+        if (stop_search.load(std::memory_order_relaxed)) return 0;
 
         if (score >= beta) return beta;  // Beta cutoff
         if (score > alpha) alpha = score;  // Improve alpha
@@ -555,29 +834,65 @@ int ChessAI::endgameQuiescence(std::unique_ptr<Bitboard>& board, int alpha, int
     return alpha;  // Best evaluation we found
 }
 
-int ChessAI::evaluateEndgameBoard(std::unique_ptr<Bitboard>& board, int depth, bool maximizing) {
-    int score = 0;
-    if (board->state.isCheckmateWhite()) score = -MATE_SCORE + (depth * 1000);  // White loses
-    else if (board->state.isCheckmateBlack()) score = MATE_SCORE - (depth * 1000); // Black loses
-    else if (board->state.isStalemate()) score = 0; // Draw -> neutral outcome
-    else {
-        // Evaluate material and positional score of the board
-        score = board->evaluateBoard();
+int ChessAI::evaluateEndgameBoard(std::unique_ptr<Bitboard>& board, bool maximizing) {
+    // Evaluate material and positional score of the board
+    int score = board->evaluateBoard();
 
-        // Evaluate passed pawns
-        score += board->evaluatePassedPawns(true) - board->evaluatePassedPawns(false); // Passed pawn delta between white and black
+    // Evaluate passed pawns
+    score += board->evaluatePassedPawns(true) - board->evaluatePassedPawns(false); // Passed pawn delta between white and black
 
-        // Encourage closing distance between kings by giving bonus
-        score += 10 * (7 - board->calculateKingDistance());
+    // Encourage closing distance between kings by giving bonus
+    score += 10 * (7 - board->calculateKingDistance());
 
-        // Award king centralization (if opponent is more centralized acts as a penalty)
-        score += board->getKingCentralization();
-    }
+    // Award king centralization (if opponent is more centralized acts as a penalty)
+    score += board->getKingCentralization();
 
     // Return the score (negate for black)
     return maximizing ? score : -score;
 }
 
+inline bool ChessAI::searchStopped() {
+    // Poll the clock every TIME_CHECK_INTERVAL nodes, the flag itself is cheap to read in between
+    // Only the main thread looks at the clock, helpers are stopped by it
+    if ((++current_thread->stats.nodes & TIME_CHECK_INTERVAL) == 0 && current_thread->id == 0 && time_manager.hardLimitReached()) {
+        stop_search.store(true, std::memory_order_relaxed);
+    }
+    return stop_search.load(std::memory_order_relaxed);
+}
+
+int ChessAI::lateMoveReduction(uint32_t move, int depth, int ply, int move_index, bool gives_check) {
+    int reduction = Tables::LMR_REDUCTIONS[std::min(depth, MAX_DEPTH - 1)][std::min(move_index, MAX_MOVES - 1)];
+
+    // Reduce less for moves that have been good before and for checks
+    if (isKillerMove(from(move), to(move), piece(move), ply)) reduction--;
+    if (gives_check) reduction--;
+    reduction -= std::clamp(getHistoryScore(from(move), to(move), piece(move)) / LMR_HISTORY_DIVISOR, 0, LMR_MAX_HISTORY_BONUS);
+
+    return std::clamp(reduction, 0, depth - 2); // Keep at least one ply before quiescence
+}
+
+int ChessAI::nullMoveReduction(int depth, int static_eval, int beta) {
+    // Callers clamp the reduced depth at 0, the depth indexed killer table has no negative plies
+    return NULL_MOVE_REDUCTION + depth / NULL_MOVE_DEPTH_DIVISOR +
+        std::min((static_eval - beta) / NULL_MOVE_EVAL_DIVISOR, NULL_MOVE_MAX_EVAL_REDUCTION);
+}
+
+int ChessAI::scoreToTT(int score, int ply) {
+    // Mate scores are stored relative to this node instead of the root
+    // The ply is the distance from the root, the game ply would push mates out of the mate band
+    assert(ply >= 0 && ply < MAX_SEARCH_DEPTH);
+    if (score > MATE_SCORE - MAX_PLY_FROM_MATE) return score + ply;
+    if (score < -MATE_SCORE + MAX_PLY_FROM_MATE) return score - ply;
+    return score;
+}
+
+int ChessAI::scoreFromTT(int score, int ply) {
+    assert(ply >= 0 && ply < MAX_SEARCH_DEPTH);
+    if (score > MATE_SCORE - MAX_PLY_FROM_MATE) return score - ply;
+    if (score < -MATE_SCORE + MAX_PLY_FROM_MATE) return score + ply;
+    return score;
+}
+
 inline bool ChessAI::isCapture(uint32_t move) {
     return capturedPiece(move) != EMPTY || moveType(move) == EN_PASSANT;
 }
@@ -599,26 +914,54 @@ uint16_t ChessAI::moveKey(int from, int to, PieceType piece) {
 
 }
 
-void ChessAI::updateKillerMoves(uint32_t move, int depth) {
+void ChessAI::updateKillerMoves(uint32_t move, int ply) {
     uint16_t key = moveKey(move); // Generate key
+    uint16_t* killers = current_thread->stack[ply].killers;
 
-    if (key != Tables::KILLER_MOVES[depth][0]) {
-        Tables::KILLER_MOVES[depth][1] = Tables::KILLER_MOVES[depth][0]; // Shift old move
-        Tables::KILLER_MOVES[depth][0] = key; // Store new move
+    if (key != killers[0]) {
+        killers[1] = killers[0]; // Shift old move
+        killers[0] = key; // Store new move
     }
 }
 
 void ChessAI::updateHistory(uint32_t move, int depth) {
     uint16_t key = moveKey(move); // Generate key
-    Tables::HISTORY_TABLE[key] += depth * depth; // Higher weight for deeper cutoffs
+    current_thread->history_table[key] += depth * depth; // Higher weight for deeper cutoffs
 }
 
-bool ChessAI::isKillerMove(int from, int to, PieceType piece, int depth) {
+bool ChessAI::isKillerMove(int from, int to, PieceType piece, int ply) {
     uint16_t key = moveKey(from, to, piece); // Get key
-    return key == Tables::KILLER_MOVES[depth][0] || key == Tables::KILLER_MOVES[depth][1];
+    const uint16_t* killers = current_thread->stack[ply].killers;
+    return key == killers[0] || key == killers[1];
 }
 
 int ChessAI::getHistoryScore(int from, int to, PieceType piece) {
     uint16_t key = moveKey(from, to, piece); // Get key
-    return Tables::HISTORY_TABLE[key];
+    return current_thread->history_table[key];
+}
+
+const SearchStats& ChessAI::getLastSearchStats() {
+    return last_stats;
+}
+
+void ChessAI::setThreadCount(int count) {
+    thread_count = std::clamp(count, 1, MAX_SEARCH_THREADS);
+}
+
+void ChessAI::setCopyMake(bool enabled) {
+    copy_make = enabled;
+}
+
+void ChessAI::prepareThreads() {
+    // Keep existing threads so their heuristic tables survive between moves
+    if (static_cast<int>(threads.size()) > thread_count) {
+        threads.resize(thread_count);
+    }
+    while (static_cast<int>(threads.size()) < thread_count) {
+        threads.push_back(std::make_unique<SearchThread>(static_cast<int>(threads.size())));
+    }
+}
+
+void ChessAI::releaseThreads() {
+    threads.clear();
 }
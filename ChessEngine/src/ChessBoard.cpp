@@ -11,6 +11,15 @@ ChessBoard::ChessBoard() :
     board = std::make_unique<Bitboard>();
 }
 
+ChessBoard::ChessBoard(const ChessBoard& other) :
+    board(std::make_unique<Bitboard>(*other.board)),
+    white(other.white),
+    full_moves(other.full_moves),
+    isEndgame(other.isEndgame),
+    previous_move(other.previous_move)
+{
+}
+
 uint64_t ChessBoard::LegalMoves(int square) {
     // Validate move notation
     if (square < 0 || square > 63) return 0ULL;
@@ -51,12 +60,27 @@ void ChessBoard::MovePiece(int source, int target, char promotion_char) {
 }
 
 void ChessBoard::MakeMoveAI(int depth, bool maximizing) {
+    SearchLimits limits;
+    limits.max_depth = depth;
+    makeMoveAI(limits, maximizing);
+}
+
+void ChessBoard::MakeMoveAITimed(int time_left_ms, int increment_ms, int moves_to_go, int move_time_ms, bool maximizing) {
+    SearchLimits limits;
+    limits.time_left_ms = time_left_ms;
+    limits.increment_ms = increment_ms;
+    limits.moves_to_go = moves_to_go;
+    limits.move_time_ms = move_time_ms;
+    makeMoveAI(limits, maximizing);
+}
+
+void ChessBoard::makeMoveAI(const SearchLimits& limits, bool maximizing) {
     uint32_t best_move;
 	if (isEndgame) {
-		best_move = ChessAI::getBestEndgameMove(board, depth, maximizing);
+		best_move = ChessAI::getBestEndgameMove(board, limits, maximizing);
 	}
 	else {
-		best_move = ChessAI::getBestMove(board, depth, maximizing);
+		best_move = ChessAI::getBestMove(board, limits, maximizing);
 	}
 
 	if (best_move == 0) {
@@ -68,6 +92,7 @@ void ChessBoard::MakeMoveAI(int depth, bool maximizing) {
 	board->applyMoveAI(best_move, maximizing);
     if (!white) full_moves++;
 
+    board->updateGameOver(maximizing); // Check if resulted in checkmate or stalemate
     board->updateDrawByRepetition(); // Check if resulted in draw by repetition
 
     // Transform move to algebraic notation
@@ -211,19 +236,19 @@ std::string ChessBoard::getMoveNotation(uint32_t move) const {
     }
 
     // Handle check and mate marking
-    if (board->state.isCheckmateWhite() || board->state.isCheckmateBlack()) algebraic_move += "#";
-    else if (board->state.isCheckWhite() || board->state.isCheckBlack()) algebraic_move += "+";
+    if (board->getState().isCheckmateWhite() || board->getState().isCheckmateBlack()) algebraic_move += "#";
+    else if (board->getState().isCheckWhite() || board->getState().isCheckBlack()) algebraic_move += "+";
 
     return algebraic_move;
 }
 
 std::string ChessBoard::GetGameState() {
-    if (board->state.isCheckmateWhite() || board->state.isCheckmateBlack()) return "mate";
-    else if (board->state.isCheckWhite() || board->state.isCheckBlack()) return "check";
-    else if (board->state.isStalemate()) return "stalemate";
-    else if (board->state.isDrawRepetition()) return "draw_repetition";
-    else if (board->state.isDraw50()) return "draw_50";
-    // else if (board->state.isDrawInsufficient()) return "draw_insufficient";
+    if (board->getState().isCheckmateWhite() || board->getState().isCheckmateBlack()) return "mate";
+    else if (board->getState().isCheckWhite() || board->getState().isCheckBlack()) return "check";
+    else if (board->getState().isStalemate()) return "stalemate";
+    else if (board->getState().isDrawRepetition()) return "draw_repetition";
+    else if (board->getState().isDraw50()) return "draw_50";
+    // else if (board->getState().isDrawInsufficient()) return "draw_insufficient";
     return "ongoing"; // Normal game state
 }
 
@@ -1,25 +1,39 @@
 #include "pch.h"
 #include "ChessEngineExports.hpp"
 #include "ChessBoard.hpp"
-#include "MoveTables.hpp"
+#include "Sliders.hpp"
 #include "Tables.hpp"
+#include "ChessAI.hpp"
+
+// Boards alive, the shared tables are torn down with the last one
+static std::atomic<int> board_count{ 0 };
 
 extern "C" CHESSENGINE_API void* CreateBoard() {
-    // Init once, safely
-    MoveTables::initMoveTables();
+    // Move, magic, geometry and Zobrist tables are compile-time data, only the TT is allocated here
     Tables::initTables();
 
+    board_count++;
     return new ChessBoard(); // Return a pointer to the new Board object
 }
 
+extern "C" CHESSENGINE_API void* CloneBoard(void* board) {
+    if (!board) return nullptr; // Prevent crashes
+    ChessBoard* b = static_cast<ChessBoard*>(board); // Cast void* to ChessBoard*
+
+    board_count++;
+    return new ChessBoard(*b); // Tables are already initialized by the original
+}
+
 extern "C" CHESSENGINE_API void DestroyBoard(void* board) {
     if (board) {
         delete static_cast<ChessBoard*>(board); // Cast the void* back to ChessBoard* and delete it
+        board_count--;
     }
 
-    // Teardown after use
+    // Teardown after the last board
+    if (board_count > 0) return;
+    ChessAI::releaseThreads();
     Tables::teardownTables();
-    MoveTables::teardownMoveTables();
 }
 
 extern "C" CHESSENGINE_API uint64_t ValidMoves(void* board, int square) {
@@ -40,6 +54,68 @@ extern "C" CHESSENGINE_API void MakeBestMove(void* board, int depth, bool white)
     b->MakeMoveAI(depth, white); // Apply move
 }
 
+extern "C" CHESSENGINE_API void MakeBestMoveTimed(void* board, int time_left_ms, int increment_ms, int moves_to_go, int move_time_ms, bool white) {
+    if (!board) return; // Prevent crashes
+    ChessBoard* b = static_cast<ChessBoard*>(board); // Cast void* to ChessBoard*
+    b->MakeMoveAITimed(time_left_ms, increment_ms, moves_to_go, move_time_ms, white); // Apply move
+}
+
+extern "C" CHESSENGINE_API void SetThreads(int threads) {
+    ChessAI::setThreadCount(threads); // Clamped to the supported range
+}
+
+extern "C" CHESSENGINE_API void SetCopyMake(bool enabled) {
+    ChessAI::setCopyMake(enabled);
+}
+
+extern "C" CHESSENGINE_API bool SetSliderBackend(int backend) {
+    if (backend < SLIDER_MAGIC || backend > SLIDER_HYPERBOLA) return false;
+    SliderBackend slider_backend = static_cast<SliderBackend>(backend);
+    if (!Sliders::isSupported(slider_backend)) return false;
+
+    Sliders::setBackend(slider_backend);
+    return true;
+}
+
+extern "C" CHESSENGINE_API int GetSliderBackend() {
+    return Sliders::backend;
+}
+
+extern "C" CHESSENGINE_API double BenchSliderBackend(int backend, int lookups) {
+    if (backend < SLIDER_MAGIC || backend > SLIDER_HYPERBOLA) return 0.0;
+    return Sliders::benchmark(static_cast<SliderBackend>(backend), lookups);
+}
+
+extern "C" CHESSENGINE_API void SetHashSize(int size_mb) {
+    Tables::resizeTT(static_cast<size_t>(std::max(size_mb, 0))); // Clamped to the supported range
+}
+
+extern "C" CHESSENGINE_API void ClearHash() {
+    Tables::clearTT();
+}
+
+extern "C" CHESSENGINE_API int GetHashfull() {
+    return Tables::hashfullTT();
+}
+
+extern "C" CHESSENGINE_API bool SaveHash(const char* path) {
+    return Tables::saveTT(path);
+}
+
+extern "C" CHESSENGINE_API bool LoadHash(const char* path) {
+    return Tables::loadTT(path);
+}
+
+extern "C" CHESSENGINE_API void GetSearchStats(uint64_t* nodes, uint64_t* zero_window_searches, uint64_t* researches, int* depth, int64_t* time_ms) {
+    if (!nodes || !zero_window_searches || !researches || !depth || !time_ms) return; // Prevent crashes
+    const SearchStats& stats = ChessAI::getLastSearchStats();
+    *nodes = stats.nodes;
+    *zero_window_searches = stats.zero_window_searches;
+    *researches = stats.researches;
+    *depth = stats.depth;
+    *time_ms = stats.time_ms;
+}
+
 extern "C" CHESSENGINE_API void GetBoardJSON(void* board, char* output, int size) {
     if (!board) return; // Prevent crashes if the board is null
 
@@ -3,155 +3,140 @@
 #include "Utils.hpp"
 
 namespace Magic {
-    // Static allocation of tables
-    // Declared as global arrays
-    MagicMoves MAGIC_TABLE_BISHOP[64];
-    MagicMoves MAGIC_TABLE_ROOK[64];
-
-    std::atomic<bool> initialized{ false };
-
-    uint64_t maskBishopAttackRays(int square) {
-        uint64_t attacks = 0ULL;
-
-        // Get rank and file as bitmasks
-        uint64_t rank = Utils::getRank(square);
-        uint64_t file = Utils::getFile(square);
-
-        // Generate attack rays
-        for (int r = static_cast<int>(rank) + 1, f = static_cast<int>(file) + 1; r < 7 && f < 7; r++, f++) {
-            attacks |= (1ULL << Utils::getSquare(r, f));
-        }
-
-        for (int r = static_cast<int>(rank) + 1, f = static_cast<int>(file) - 1; r < 7 && f > 0; r++, f--) {
-            attacks |= (1ULL << Utils::getSquare(r, f));
-        }
-
-        for (int r = static_cast<int>(rank) - 1, f = static_cast<int>(file) + 1; r > 0 && f < 7; r--, f++) {
-            attacks |= (1ULL << Utils::getSquare(r, f));
-        }
-
-        for (int r = static_cast<int>(rank) - 1, f = static_cast<int>(file) - 1; r > 0 && f > 0; r--, f--) {
-            attacks |= (1ULL << Utils::getSquare(r, f));
-        }
-
-        return attacks;
+    // Magic and PEXT slice layout of both pieces, bishops first
+    struct MagicLayout {
+        std::array<MagicMoves, 64> bishop;
+        std::array<MagicMoves, 64> rook;
+    };
+
+    // Occupancies of a mask are walked with the carry-rippler, occupancy = (occupancy - mask) & mask
+    // The n-th occupancy sets the mask bits of n from the lowest up, which is exactly its PEXT index
+
+    // Highest index the magic maps an occupancy of the mask to, + 1
+    constexpr uint32_t magicSpan(uint64_t mask, uint64_t magic, int shift) {
+        uint64_t highest = 0ULL;
+        uint64_t occupancy = 0ULL;
+        do {
+            uint64_t index = (occupancy * magic) >> shift;
+            if (index > highest) highest = index;
+            occupancy = (occupancy - mask) & mask;
+        } while (occupancy);
+        return static_cast<uint32_t>(highest) + 1;
     }
 
-    uint64_t maskRookAttackRays(int square) {
-        uint64_t attacks = 0ULL;
-
-        // Get rank and file as bitmasks
-        uint64_t rank = Utils::getRank(square);
-        uint64_t file = Utils::getFile(square);
+    constexpr MagicLayout buildLayout() {
+        MagicLayout layout{};
+        uint32_t offset = 0;
+        uint32_t pext_offset = 0;
 
-        // Generate attack rays
-        for (int r = static_cast<int>(rank) + 1; r < 7; r++) {
-            attacks |= (1ULL << Utils::getSquare(r, static_cast<int>(file)));
-        }
-
-        for (int r = static_cast<int>(rank) - 1; r > 0; r--) {
-            attacks |= (1ULL << Utils::getSquare(r, static_cast<int>(file)));
-        }
-
-        for (int f = static_cast<int>(file) + 1; f < 7; f++) {
-            attacks |= (1ULL << Utils::getSquare(static_cast<int>(rank), f));
+        // Init bishop
+        for (int sq = 0; sq < 64; sq++) {
+            MagicMoves& entry = layout.bishop[sq];
+            entry.mask = maskBishopAttackRays(sq);
+            entry.magic = MAGICS_BISHOP[sq];
+            entry.shift = 64 - INDEX_BITS_BISHOP[sq];
+            entry.offset = offset;
+            entry.pext_offset = pext_offset;
+            offset += magicSpan(entry.mask, entry.magic, entry.shift);
+            pext_offset += 1U << RELEVANT_BITS_COUNT_BISHOP[sq];
         }
 
-        for (int f = static_cast<int>(file) - 1; f > 0; f--) {
-            attacks |= (1ULL << Utils::getSquare(static_cast<int>(rank), f));
+        // Init rook
+        for (int sq = 0; sq < 64; sq++) {
+            MagicMoves& entry = layout.rook[sq];
+            entry.mask = maskRookAttackRays(sq);
+            entry.magic = MAGICS_ROOK[sq];
+            entry.shift = 64 - INDEX_BITS_ROOK[sq];
+            entry.offset = offset;
+            entry.pext_offset = pext_offset;
+            offset += magicSpan(entry.mask, entry.magic, entry.shift);
+            pext_offset += 1U << RELEVANT_BITS_COUNT_ROOK[sq];
         }
 
-        return attacks;
+        return layout;
     }
 
-    uint64_t maskBishopXrayAttacks(int square, uint64_t blockers) {
-        uint64_t attacks = 0ULL;
-
-        // Get rank and file as bitmasks
-        uint64_t rank = Utils::getRank(square);
-        uint64_t file = Utils::getFile(square);
-
-        // Generate xrays, stop traversing a ray after encountering a blocker
-        for (int r = static_cast<int>(rank) + 1, f = static_cast<int>(file) + 1; r < 8 && f < 8; r++, f++) {
-            attacks |= (1ULL << Utils::getSquare(r, f));
-            if ((1ULL << Utils::getSquare(r, f) & blockers)) break;
-        }
-
-        for (int r = static_cast<int>(rank) + 1, f = static_cast<int>(file) - 1; r < 8 && f >= 0; r++, f--) {
-            attacks |= (1ULL << Utils::getSquare(r, f));
-            if ((1ULL << Utils::getSquare(r, f) & blockers)) break;
-        }
-
-        for (int r = static_cast<int>(rank) - 1, f = static_cast<int>(file) + 1; r >= 0 && f < 8; r--, f++) {
-            attacks |= (1ULL << Utils::getSquare(r, f));
-            if ((1ULL << Utils::getSquare(r, f) & blockers)) break;
-        }
-
-        for (int r = static_cast<int>(rank) - 1, f = static_cast<int>(file) - 1; r >= 0 && f >= 0; r--, f--) {
-            attacks |= (1ULL << Utils::getSquare(r, f));
-            if ((1ULL << Utils::getSquare(r, f) & blockers)) break;
-        }
-
-        return attacks;
+    constexpr MagicLayout LAYOUT = buildLayout();
+
+    // Empty board rays, the first four directions run towards higher squares
+    struct Rays {
+        uint64_t rays[8][64];
+    };
+
+    constexpr Rays buildRays() {
+        constexpr int steps[8][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { 1, -1 }, { -1, 0 }, { 0, -1 }, { -1, -1 }, { -1, 1 } }; // Rank and file steps
+        Rays rays{};
+        for (int dir = 0; dir < 8; dir++) {
+            for (int sq = 0; sq < 64; sq++) {
+                int rank = Utils::getRank(sq) + steps[dir][0];
+                int file = Utils::getFile(sq) + steps[dir][1];
+                for (; rank >= 0 && rank < 8 && file >= 0 && file < 8; rank += steps[dir][0], file += steps[dir][1]) {
+                    rays.rays[dir][sq] |= 1ULL << Utils::getSquare(rank, file);
+                }
+            }
+        }
+        return rays;
     }
 
-    uint64_t maskRookXrayAttacks(int square, uint64_t blockers) {
-        uint64_t attacks = 0ULL;
-
-        // Get rank and file as bitmasks
-        uint64_t rank = Utils::getRank(square);
-        uint64_t file = Utils::getFile(square);
-
-        // Generate xrays, stop traversing a ray after encountering a blocker
-        for (int r = static_cast<int>(rank) + 1; r < 8; r++) {
-            attacks |= (1ULL << Utils::getSquare(r, static_cast<int>(file)));
-            if ((1ULL << Utils::getSquare(r, static_cast<int>(file)) & blockers)) break;
-        }
-
-        for (int r = static_cast<int>(rank) - 1; r >= 0; r--) {
-            attacks |= (1ULL << Utils::getSquare(r, static_cast<int>(file)));
-            if ((1ULL << Utils::getSquare(r, static_cast<int>(file)) & blockers)) break;
-        }
-
-        for (int f = static_cast<int>(file) + 1; f < 8; f++) {
-            attacks |= (1ULL << Utils::getSquare(static_cast<int>(rank), f));
-            if ((1ULL << Utils::getSquare(static_cast<int>(rank), f) & blockers)) break;
-        }
-
-        for (int f = static_cast<int>(file) - 1; f >= 0; f--) {
-            attacks |= (1ULL << Utils::getSquare(static_cast<int>(rank), f));
-            if ((1ULL << Utils::getSquare(static_cast<int>(rank), f) & blockers)) break;
-        }
-
-        return attacks;
+    constexpr Rays RAYS = buildRays();
+
+    // Ray cut behind its nearest blocker, the lowest blocker on rays to higher squares and the highest on the others
+    // Same sets as maskBishopXrayAttacks/maskRookXrayAttacks with a fraction of the compile-time steps
+    constexpr uint64_t rayAttacks(int dir, int sq, uint64_t occupied) {
+        uint64_t ray = RAYS.rays[dir][sq];
+        uint64_t blockers = ray & occupied;
+        if (!blockers) return ray;
+        if (dir < 4) {
+            uint64_t nearest = blockers & (~blockers + 1);
+            return ray & ((nearest << 1) - 1);
+        }
+        blockers |= blockers >> 1;
+        blockers |= blockers >> 2;
+        blockers |= blockers >> 4;
+        blockers |= blockers >> 8;
+        blockers |= blockers >> 16;
+        blockers |= blockers >> 32;
+        uint64_t nearest = blockers ^ (blockers >> 1);
+        return ray & ~(nearest - 1);
     }
 
-    void initMagicTables() {
-        bool expected = false;
-        if (!initialized.compare_exchange_strong(expected, true)) {
-            return; // Already initialized
-        }
+    constexpr uint64_t bishopAttacks(int sq, uint64_t occupied) {
+        return rayAttacks(2, sq, occupied) | rayAttacks(3, sq, occupied) | rayAttacks(6, sq, occupied) | rayAttacks(7, sq, occupied);
+    }
 
-        // Init bishop
-        for (int sq = 0; sq < 64; sq++) {
-            MAGIC_TABLE_BISHOP[sq].mask = maskBishopAttackRays(sq);
-            MAGIC_TABLE_BISHOP[sq].magic = MAGICS_BISHOP[sq];
-            MAGIC_TABLE_BISHOP[sq].shift = 64 - RELEVANT_BITS_COUNT_BISHOP[sq];
-        }
+    constexpr uint64_t rookAttacks(int sq, uint64_t occupied) {
+        return rayAttacks(0, sq, occupied) | rayAttacks(1, sq, occupied) | rayAttacks(4, sq, occupied) | rayAttacks(5, sq, occupied);
+    }
 
-        // Init rook
+    // Fill the slices of one piece in the index order of the magic or PEXT backend
+    template <bool Pext>
+    constexpr void fillSlices(uint64_t* attacks, const std::array<MagicMoves, 64>& entries, uint64_t (*slider_attacks)(int, uint64_t)) {
         for (int sq = 0; sq < 64; sq++) {
-            MAGIC_TABLE_ROOK[sq].mask = maskRookAttackRays(sq);
-            MAGIC_TABLE_ROOK[sq].magic = MAGICS_ROOK[sq];
-            MAGIC_TABLE_ROOK[sq].shift = 64 - RELEVANT_BITS_COUNT_ROOK[sq];
+            const MagicMoves& entry = entries[sq];
+            uint64_t occupancy = 0ULL;
+            size_t pext_index = 0;
+            do {
+                size_t index = Pext ? entry.pext_offset + pext_index++ : entry.offset + static_cast<size_t>((occupancy * entry.magic) >> entry.shift);
+                attacks[index] = slider_attacks(sq, occupancy);
+                occupancy = (occupancy - entry.mask) & entry.mask;
+            } while (occupancy);
         }
     }
 
-    void teardownTables() {
-        initialized.store(false);
-        // Zero out table contents just in case
-        std::memset(MAGIC_TABLE_BISHOP, 0, sizeof(MAGIC_TABLE_BISHOP));
-        std::memset(MAGIC_TABLE_ROOK, 0, sizeof(MAGIC_TABLE_ROOK));
+    // One table per constant evaluation, the compilers limit the steps of a single evaluation (MSVC: /constexpr:steps)
+    template <bool Pext, size_t Size>
+    constexpr std::array<uint64_t, Size> buildAttacks() {
+        std::array<uint64_t, Size> attacks{};
+        fillSlices<Pext>(attacks.data(), LAYOUT.bishop, bishopAttacks);
+        fillSlices<Pext>(attacks.data(), LAYOUT.rook, rookAttacks);
+        return attacks;
     }
-}
 
+    static_assert(LAYOUT.rook[63].offset + magicSpan(LAYOUT.rook[63].mask, LAYOUT.rook[63].magic, LAYOUT.rook[63].shift) <= MAGIC_ATTACKS_SIZE,
+        "Magic slices must fit the table");
+
+    constinit const std::array<MagicMoves, 64> MAGIC_TABLE_BISHOP = LAYOUT.bishop;
+    constinit const std::array<MagicMoves, 64> MAGIC_TABLE_ROOK = LAYOUT.rook;
+    constinit const std::array<uint64_t, MAGIC_ATTACKS_SIZE> MAGIC_ATTACKS = buildAttacks<false, MAGIC_ATTACKS_SIZE>();
+    constinit const std::array<uint64_t, PEXT_ATTACKS_SIZE> PEXT_ATTACKS = buildAttacks<true, PEXT_ATTACKS_SIZE>();
+}
@@ -0,0 +1,139 @@
+#include "pch.h"
+#include "MovePicker.hpp"
+#include "Bitboard.hpp"
+
+MovePicker::MovePicker(Bitboard& board, bool white, uint16_t tt_key, const uint16_t* killer_keys, int depth, bool endgame) :
+    board(board),
+    white(white),
+    endgame(endgame),
+    quiescence(false),
+    depth(depth),
+    stage(TT_MOVE),
+    tt_key(tt_key),
+    tt_move(NULL_MOVE_32),
+    killer_keys(killer_keys),
+    killers{ NULL_MOVE_32, NULL_MOVE_32 },
+    killer_index(0),
+    current(0),
+    end(0),
+    bad_captures_begin(0),
+    bad_captures_end(0)
+{}
+
+MovePicker::MovePicker(Bitboard& board, bool white, bool endgame) :
+    board(board),
+    white(white),
+    endgame(endgame),
+    quiescence(true),
+    depth(0),
+    stage(GENERATE_ALL),
+    tt_key(NULL_MOVE),
+    tt_move(NULL_MOVE_32),
+    killer_keys(nullptr),
+    killers{ NULL_MOVE_32, NULL_MOVE_32 },
+    killer_index(0),
+    current(0),
+    end(0),
+    bad_captures_begin(0),
+    bad_captures_end(0)
+{}
+
+ScoredMove& MovePicker::selectBest() {
+    int best = current;
+    for (int i = current + 1; i < end; i++) {
+        if (moves[i].score > moves[best].score) best = i;
+    }
+    std::swap(moves[current], moves[best]);
+    return moves[current];
+}
+
+uint32_t MovePicker::nextMove() {
+    while (true) {
+        switch (stage) {
+        case TT_MOVE:
+            stage = endgame ? GENERATE_ALL : GENERATE_CAPTURES;
+            // Rebuilt here so the later stages can skip it among the generated moves
+            tt_move = board.decodeMove(tt_key, white, endgame);
+            if (tt_move != NULL_MOVE_32 && board.isLegalMove(tt_move, white, endgame)) {
+                return tt_move;
+            }
+            break;
+
+        case GENERATE_CAPTURES:
+            board.generateCaptures(moves, end, white);
+            stage = GOOD_CAPTURES;
+            break;
+
+        case GOOD_CAPTURES:
+            while (current < end) {
+                ScoredMove& best = selectBest();
+                if (best.score < 0) break; // Only losing captures left
+                current++;
+                if (best.move != tt_move) return best.move;
+            }
+            bad_captures_begin = current;
+            bad_captures_end = end;
+            stage = KILLERS;
+            break;
+
+        case KILLERS:
+            // Killers aren't used at the root
+            while (depth > 0 && killer_keys && killer_index < 2) {
+                int index = killer_index++;
+                uint32_t killer = board.quietMoveFromKey(killer_keys[index], white);
+                if (killer == NULL_MOVE_32 || killer == tt_move || killer == killers[0]) continue;
+                killers[index] = killer;
+                return killer;
+            }
+            stage = GENERATE_QUIETS;
+            break;
+
+        case GENERATE_QUIETS:
+            // Quiet moves go after the bad captures
+            current = bad_captures_end;
+            end = bad_captures_end;
+            board.generateQuiets(moves, end, depth, white);
+            stage = QUIETS;
+            break;
+
+        case QUIETS:
+            while (current < end) {
+                uint32_t move = selectBest().move;
+                current++;
+                if (move != tt_move && move != killers[0] && move != killers[1]) return move;
+            }
+            current = bad_captures_begin;
+            end = bad_captures_end;
+            stage = BAD_CAPTURES;
+            break;
+
+        case BAD_CAPTURES:
+            while (current < end) {
+                uint32_t move = selectBest().move;
+                current++;
+                if (move != tt_move) return move;
+            }
+            stage = DONE;
+            break;
+
+        case GENERATE_ALL:
+            if (!endgame) board.generateCaptures(moves, end, white);
+            else if (quiescence) board.generateEndgameNoisyMoves(moves, end, white);
+            else board.generateEndgameMoves(moves, end, depth, white);
+            stage = ALL_MOVES;
+            break;
+
+        case ALL_MOVES:
+            while (current < end) {
+                uint32_t move = selectBest().move;
+                current++;
+                if (move != tt_move) return move;
+            }
+            stage = DONE;
+            break;
+
+        case DONE:
+            return NULL_MOVE_32;
+        }
+    }
+}
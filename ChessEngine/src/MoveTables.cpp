@@ -1,23 +1,9 @@
 #include "pch.h"
 #include "MoveTables.hpp"
-#include "Magic.hpp"
 #include "Utils.hpp"
 
 namespace MoveTables {
-	// Static allocation of tables
-	// Declared as global arrays
-	PawnMoves WHITE_PAWN_MOVES[64];
-	PawnMoves BLACK_PAWN_MOVES[64];
-	KnightMoves KNIGHT_MOVES[64];
-	KingMoves KING_MOVES[64];
-
-	// Define the large tables
-	uint64_t(*ATTACKS_BISHOP)[512] = new uint64_t[64][512];
-	uint64_t(*ATTACKS_ROOK)[4096] = new uint64_t[64][4096];
-
-	std::atomic<bool> initialized{ false }; // Atomic for thread safety
-
-	void initWhitePawnMoves(int square) {
+	constexpr PawnMoves whitePawnMoves(int square) {
 		uint64_t bitboard = 1ULL << square; // Cast square to bitboard
 
 		uint64_t single_push = bitboard << 8; // Single step
@@ -28,11 +14,10 @@ namespace MoveTables {
 		if (!(bitboard & FILE_A)) captures |= (bitboard << 7); // NW attack
 		if (!(bitboard & FILE_H)) captures |= (bitboard << 9); // NE attack
 
-		// Insert moveset at square
-		WHITE_PAWN_MOVES[square] = { single_push, double_push, captures };
+		return { single_push, double_push, captures };
 	}
 
-	void initBlackPawnMoves(int square) {
+	constexpr PawnMoves blackPawnMoves(int square) {
 		uint64_t bitboard = 1ULL << square; // Cast square to bitboard
 
 		uint64_t single_push = bitboard >> 8; // Single step
@@ -43,11 +28,10 @@ namespace MoveTables {
 		if (!(bitboard & FILE_A)) captures |= (bitboard >> 9); // SW attack
 		if (!(bitboard & FILE_H)) captures |= (bitboard >> 7); // SE attack
 
-		// Insert moveset at square
-		BLACK_PAWN_MOVES[square] = { single_push, double_push, captures };
+		return { single_push, double_push, captures };
 	}
 
-	void initKnightMoves(int square) {
+	constexpr KnightMoves knightMoves(int square) {
 		uint64_t bitboard = 1ULL << square; // Place knight on the square
 		uint64_t moves = 0ULL;
 
@@ -72,11 +56,10 @@ namespace MoveTables {
 			moves |= (jump < 0) ? (bitboard >> -jump) : (bitboard << jump);
 		}
 
-		// Store the calculated moves for this square
-		KNIGHT_MOVES[square] = { moves };
+		return { moves };
 	}
 
-	void initKingMoves(int square) {
+	constexpr KingMoves kingMoves(int square) {
 		uint64_t bitboard = 1ULL << square; // Convert square index to bitboard
 		uint64_t moves = 0ULL;
 
@@ -100,70 +83,21 @@ namespace MoveTables {
 			moves |= (direction < 0) ? (bitboard >> -direction) : (bitboard << direction);
 		}
 
-		KING_MOVES[square] = { moves };
+		return { moves };
 	}
 
-	void initMoveTables() {
-		bool expected = false;
-		if (!initialized.compare_exchange_strong(expected, true)) {
-			return; // Already initialized
-		}
-
-		// Reallocate if needed
-		if (ATTACKS_BISHOP == nullptr) {
-			ATTACKS_BISHOP = new uint64_t[64][512];
-		}
-		if (ATTACKS_ROOK == nullptr) {
-			ATTACKS_ROOK = new uint64_t[64][4096];
-		}
-
-		// Non-sliding pieces
+	// Moveset of each square
+	template <typename Moves>
+	constexpr std::array<Moves, 64> buildTable(Moves (*moves)(int)) {
+		std::array<Moves, 64> table{};
 		for (int square = 0; square < 64; square++) {
-			initWhitePawnMoves(square);
-			initBlackPawnMoves(square);
-			initKnightMoves(square);
-			initKingMoves(square);
-		}
-
-		// Initialize magic tables
-		Magic::initMagicTables();
-
-		// Bishop
-		for (int sq = 0; sq < 64; sq++) {
-			int occupancy_indices = 1 << Magic::RELEVANT_BITS_COUNT_BISHOP[sq];
-			for (int i = 0; i < occupancy_indices; i++) {
-				uint64_t occupancy = Utils::setOccupancy(i, Magic::RELEVANT_BITS_COUNT_BISHOP[sq], Magic::MAGIC_TABLE_BISHOP[sq].mask);
-				int index = (int)((occupancy * Magic::MAGIC_TABLE_BISHOP[sq].magic) >> Magic::MAGIC_TABLE_BISHOP[sq].shift);
-				ATTACKS_BISHOP[sq][index] = Magic::maskBishopXrayAttacks(sq, occupancy);
-			}
-		}
-
-		// Rook
-		for (int sq = 0; sq < 64; sq++) {
-			int occupancy_indices = 1 << Magic::RELEVANT_BITS_COUNT_ROOK[sq];
-			for (int i = 0; i < occupancy_indices; i++) {
-				uint64_t occupancy = Utils::setOccupancy(i, Magic::RELEVANT_BITS_COUNT_ROOK[sq], Magic::MAGIC_TABLE_ROOK[sq].mask);
-				int index = (int)((occupancy * Magic::MAGIC_TABLE_ROOK[sq].magic) >> Magic::MAGIC_TABLE_ROOK[sq].shift);
-				ATTACKS_ROOK[sq][index] = Magic::maskRookXrayAttacks(sq, occupancy);
-			}
+			table[square] = moves(square);
 		}
+		return table;
 	}
 
-	void teardownMoveTables() {
-		if (!initialized.load()) return; // No redundant teardown
-
-		Magic::teardownTables();
-
-		// Validate before deletion
-		if (ATTACKS_BISHOP) {
-			delete[] ATTACKS_BISHOP;
-			ATTACKS_BISHOP = nullptr;
-		}
-		if (ATTACKS_ROOK) {
-			delete[] ATTACKS_ROOK;
-			ATTACKS_ROOK = nullptr;
-		}
-
-		initialized = false;
-	}
-}
\ No newline at end of file
+	constinit const std::array<PawnMoves, 64> WHITE_PAWN_MOVES = buildTable(whitePawnMoves);
+	constinit const std::array<PawnMoves, 64> BLACK_PAWN_MOVES = buildTable(blackPawnMoves);
+	constinit const std::array<KnightMoves, 64> KNIGHT_MOVES = buildTable(knightMoves);
+	constinit const std::array<KingMoves, 64> KING_MOVES = buildTable(kingMoves);
+}
@@ -1,6 +1,6 @@
 #include "pch.h"
 #include "Moves.hpp"
-#include "Magic.hpp"
+#include "Sliders.hpp"
 #include "MoveTables.hpp"
 #include "Tables.hpp"
 #include "Utils.hpp"
@@ -76,113 +76,64 @@ uint64_t Moves::getKingMoves(int king) {
 }
 
 uint64_t Moves::getBishopMoves(int bishop, uint64_t occ) {
-	uint64_t bishop_bb = 1ULL << bishop;
-
-	// Get possible attacks
-	occ &= Magic::MAGIC_TABLE_BISHOP[bishop].mask;
-	occ *= Magic::MAGIC_TABLE_BISHOP[bishop].magic;
-	occ >>= Magic::MAGIC_TABLE_BISHOP[bishop].shift;
-	return MoveTables::ATTACKS_BISHOP[bishop][occ];
+	// Lookup of the backend chosen at startup, the branch always goes the same way
+	switch (Sliders::backend) {
+	case SLIDER_PEXT: return Sliders::bishopAttacksPext(bishop, occ);
+	case SLIDER_HYPERBOLA: return Sliders::bishopAttacksHyperbola(bishop, occ);
+	default: return Sliders::bishopAttacksMagic(bishop, occ);
+	}
 }
 
 uint64_t Moves::getRookMoves(int rook, uint64_t occ) {
-	uint64_t rook_bb = 1ULL << rook;
-
-	// Get possible attacks
-	occ &= Magic::MAGIC_TABLE_ROOK[rook].mask;
-	occ *= Magic::MAGIC_TABLE_ROOK[rook].magic;
-	occ >>= Magic::MAGIC_TABLE_ROOK[rook].shift;
-	return MoveTables::ATTACKS_ROOK[rook][occ];
+	switch (Sliders::backend) {
+	case SLIDER_PEXT: return Sliders::rookAttacksPext(rook, occ);
+	case SLIDER_HYPERBOLA: return Sliders::rookAttacksHyperbola(rook, occ);
+	default: return Sliders::rookAttacksMagic(rook, occ);
+	}
 }
 
 uint64_t Moves::getQueenMoves(int queen, uint64_t occupied) {
-	uint64_t occ = occupied;
-
-	// Get rook moves
-	occ &= Magic::MAGIC_TABLE_ROOK[queen].mask;
-	occ *= Magic::MAGIC_TABLE_ROOK[queen].magic;
-	occ >>= Magic::MAGIC_TABLE_ROOK[queen].shift;
-	uint64_t moves = MoveTables::ATTACKS_ROOK[queen][occ];
-
-	// Get bishop moves
-	occ = occupied;
-	occ &= Magic::MAGIC_TABLE_BISHOP[queen].mask;
-	occ *= Magic::MAGIC_TABLE_BISHOP[queen].magic;
-	occ >>= Magic::MAGIC_TABLE_BISHOP[queen].shift;
-	moves |= MoveTables::ATTACKS_BISHOP[queen][occ]; // Combine with rook
-
-	return moves;
+	return getRookMoves(queen, occupied) | getBishopMoves(queen, occupied); // Combine rook and bishop
 }
 
-void Moves::computePinnedPieces(PinData& pin_data, const int& king_sq,
-	const uint64_t& occupied, const uint64_t& bishops, const uint64_t& rooks, const uint64_t& queen) {
-	// Reset pin data
-	pin_data.pinned = 0;
-	for (int i = 0; i < 64; i++) {
-		pin_data.pin_rays[i] = 0xFFFFFFFFFFFFFFFFULL;  // Default to allow all moves
-	}
-
-	// All potential pinners
-	uint64_t sliders = bishops | rooks | queen;
-
-	// Get all rays from the square king is at
-	// Meaning possible rays enemy could attack from
-	// Done by getting possible queen moves at this square
-	while (sliders) {
-		int slider_sq = Utils::findFirstSetBit(sliders);
-		Utils::popBit(sliders, slider_sq);
-		Direction direction = Tables::DIR[king_sq][slider_sq];
-
-		if (!direction) continue; // Not aligned
-
-		// Bishop cannot pin orthogonally
-		// Rook cannot pin diagonally
-		// Queen can pin in every direction
-		if ((direction == NORTH || direction == WEST || direction == SOUTH || direction == EAST) && bishops & (1ULL << slider_sq)) continue;
-		if ((direction == NORTH_EAST || direction == NORTH_WEST || direction == SOUTH_EAST || direction == SOUTH_WEST) && rooks & (1ULL << slider_sq)) continue;
+uint64_t Moves::computeKingBlockers(int king_sq, uint64_t occupied, uint64_t diagonal_sliders, uint64_t orthogonal_sliders) {
+	// Sliders aligned with the king on an empty board, bishops only on diagonals and rooks only on lines
+	uint64_t snipers = (getBishopMoves(king_sq, 0ULL) & diagonal_sliders) | (getRookMoves(king_sq, 0ULL) & orthogonal_sliders);
 
+	uint64_t blockers = 0ULL;
+	while (snipers) {
+		int sniper_sq = Utils::findFirstSetBit(snipers);
+		Utils::popBit(snipers, sniper_sq);
 
-		uint64_t between_mask = Tables::BETWEEN[king_sq][slider_sq]; // Bitmask of squares between king and slider
-		uint64_t blockers = between_mask & occupied; // Get pieces that align with between mask
-
-		// Check if exactly one blocker exists and extract it in one step
-		if (Utils::countSetBits(blockers) == 1) {
-			int pinned_sq = Utils::findFirstSetBit(blockers); // Get the pinned piece
-			pin_data.pinned |= (1ULL << pinned_sq); // Add to pinned
-			pin_data.pin_rays[pinned_sq] = Tables::LINE[king_sq][slider_sq]; // Get the pin ray
-		}
+		// A single piece in between is pinned (or discovers an attack if it belongs to the slider's side)
+		uint64_t between = Tables::BETWEEN[king_sq][sniper_sq] & occupied;
+		if (between && !(between & (between - 1))) blockers |= between;
 	}
+	return blockers;
 }
 
 KingDanger Moves::computeKingDanger(const int& king_sq, uint64_t occupied, bool white) {
 	// Orthogonal danger
-	uint64_t occ = occupied;
-	occ &= Magic::MAGIC_TABLE_ROOK[king_sq].mask;
-	occ *= Magic::MAGIC_TABLE_ROOK[king_sq].magic;
-	occ >>= Magic::MAGIC_TABLE_ROOK[king_sq].shift;
-	uint64_t orthogonal = MoveTables::ATTACKS_ROOK[king_sq][occ];
+	uint64_t orthogonal = getRookMoves(king_sq, occupied);
 
 	// Diagonal
-	occ = occupied;
-	occ &= Magic::MAGIC_TABLE_BISHOP[king_sq].mask;
-	occ *= Magic::MAGIC_TABLE_BISHOP[king_sq].magic;
-	occ >>= Magic::MAGIC_TABLE_BISHOP[king_sq].shift;
-	uint64_t diagonal = MoveTables::ATTACKS_BISHOP[king_sq][occ];
+	uint64_t diagonal = getBishopMoves(king_sq, occupied);
 
 	// Knight attacks
 	uint64_t knight = MoveTables::KNIGHT_MOVES[king_sq].moves;
 
-	// Pawn attacks
+	// Pawn attacks, squares a pawn of the checking side attacks the king from
+	// White pawns check from below the king and black pawns from above
 	uint64_t pawn = 0ULL;
 	uint64_t king_mask = (1ULL << king_sq);
 	if (white && king_sq >= 16) {
-		if (!(king_mask & FILE_A)) pawn |= (king_mask << 7);
-		if (!(king_mask & FILE_H)) pawn |= (king_mask << 9);
-	}
-	if (!white && king_sq <= 47) {
 		if (!(king_mask & FILE_A)) pawn |= (king_mask >> 9);
 		if (!(king_mask & FILE_H)) pawn |= (king_mask >> 7);
 	}
+	if (!white && king_sq <= 47) {
+		if (!(king_mask & FILE_A)) pawn |= (king_mask << 7);
+		if (!(king_mask & FILE_H)) pawn |= (king_mask << 9);
+	}
 	
 	// Return as struct
 	return { orthogonal, diagonal, knight, pawn };
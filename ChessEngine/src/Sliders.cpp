@@ -0,0 +1,160 @@
+#include "pch.h"
+#include "Sliders.hpp"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(SLIDERS_HAS_PEXT)
+#include <cpuid.h>
+#endif
+
+namespace Sliders {
+    SliderBackend backend = detectBackend();
+
+    // Registers eax, ebx, ecx, edx of a CPUID leaf, all zero without CPUID
+    static void cpuid(int leaf, int subleaf, uint32_t regs[4]) {
+        regs[0] = regs[1] = regs[2] = regs[3] = 0;
+#if defined(_MSC_VER) && defined(SLIDERS_HAS_PEXT)
+        int info[4];
+        __cpuidex(info, leaf, subleaf);
+        for (int i = 0; i < 4; i++) regs[i] = static_cast<uint32_t>(info[i]);
+#elif defined(SLIDERS_HAS_PEXT)
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+
+    static bool hasBmi2() {
+        uint32_t regs[4];
+        cpuid(0, 0, regs);
+        if (regs[0] < 7) return false; // Extended features leaf missing
+        cpuid(7, 0, regs);
+        return (regs[1] >> 8) & 1; // EBX bit 8
+    }
+
+    SliderBackend detectBackend() {
+        if (!hasBmi2()) return SLIDER_MAGIC;
+
+        // Vendor string is in EBX, EDX, ECX
+        uint32_t regs[4];
+        cpuid(0, 0, regs);
+        char vendor[13] = {};
+        std::memcpy(vendor, &regs[1], 4);
+        std::memcpy(vendor + 4, &regs[3], 4);
+        std::memcpy(vendor + 8, &regs[2], 4);
+
+        // Zen 1 and Zen 2 (family 0x17) run PEXT in microcode, Zen 3 (family 0x19) and later in hardware
+        cpuid(1, 0, regs);
+        uint32_t family = (regs[0] >> 8) & 0xF;
+        if (family == 0xF) family += (regs[0] >> 20) & 0xFF;
+        if (std::strcmp(vendor, "AuthenticAMD") == 0 && family < 0x19) return SLIDER_MAGIC;
+
+        return SLIDER_PEXT;
+    }
+
+    bool isSupported(SliderBackend slider_backend) {
+        switch (slider_backend) {
+        case SLIDER_MAGIC: return true;
+        case SLIDER_PEXT: return hasBmi2();
+        case SLIDER_HYPERBOLA: return true;
+        default: return false;
+        }
+    }
+
+    void setBackend(SliderBackend slider_backend) {
+        backend = isSupported(slider_backend) ? slider_backend : SLIDER_MAGIC;
+    }
+
+    // Squares on the line through the square, the square itself excluded
+    constexpr std::array<uint64_t, 64> buildLineMasks(int rank_step, int file_step) {
+        std::array<uint64_t, 64> masks{};
+        for (int sq = 0; sq < 64; sq++) {
+            for (int direction : { 1, -1 }) {
+                int rank = Utils::getRank(sq) + direction * rank_step;
+                int file = Utils::getFile(sq) + direction * file_step;
+                for (; rank >= 0 && rank < 8 && file >= 0 && file < 8; rank += direction * rank_step, file += direction * file_step) {
+                    masks[sq] |= 1ULL << Utils::getSquare(rank, file);
+                }
+            }
+        }
+        return masks;
+    }
+
+    // Edge squares never block anything behind them, only the 6 inner squares are indexed
+    constexpr std::array<std::array<uint64_t, 8>, 64> buildFirstRankAttacks() {
+        std::array<std::array<uint64_t, 8>, 64> attacks{};
+        for (int occupancy = 0; occupancy < 64; occupancy++) {
+            for (int file = 0; file < 8; file++) {
+                attacks[occupancy][file] = Magic::maskRookXrayAttacks(file, static_cast<uint64_t>(occupancy) << 1) & RANK_1;
+            }
+        }
+        return attacks;
+    }
+
+    constinit const std::array<uint64_t, 64> FILE_MASKS = buildLineMasks(1, 0);
+    constinit const std::array<uint64_t, 64> DIAGONAL_MASKS = buildLineMasks(1, 1);
+    constinit const std::array<uint64_t, 64> ANTI_DIAGONAL_MASKS = buildLineMasks(1, -1);
+    constinit const std::array<std::array<uint64_t, 8>, 64> FIRST_RANK_ATTACKS = buildFirstRankAttacks();
+
+    /*************************
+    Micro-benchmark
+    *************************/
+
+    constexpr int BENCH_SAMPLES = 4096; // Power of 2, small enough to stay in L1 next to the tables
+    constexpr uint64_t BENCH_SEED = 0x5EEDB0A4D5EEDULL;
+    volatile uint64_t bench_checksum = 0ULL; // Written after every run so the lookups can't be optimized away
+
+    struct BenchSample {
+        uint64_t occupied;
+        int square;
+    };
+
+    // One bishop and one rook lookup per sample, the checksum keeps the compiler from dropping them
+    template <uint64_t(*Bishop)(int, uint64_t), uint64_t(*Rook)(int, uint64_t)>
+    static uint64_t runLookups(const std::vector<BenchSample>& samples, int iterations) {
+        uint64_t checksum = 0ULL;
+        for (int i = 0; i < iterations; i++) {
+            const BenchSample& sample = samples[i & (BENCH_SAMPLES - 1)];
+            checksum ^= Bishop(sample.square, sample.occupied) + Rook(sample.square, sample.occupied);
+        }
+        return checksum;
+    }
+
+#ifdef SLIDERS_HAS_PEXT
+    // PEXT lookups are only inlined into code built for BMI2
+    SLIDERS_TARGET_BMI2 static uint64_t runPextLookups(const std::vector<BenchSample>& samples, int iterations) {
+        return runLookups<bishopAttacksPext, rookAttacksPext>(samples, iterations);
+    }
+#endif
+
+    double benchmark(SliderBackend slider_backend, int lookups) {
+        if (!isSupported(slider_backend) || lookups <= 0) return 0.0;
+
+        SliderBackend previous = backend;
+        setBackend(slider_backend);
+
+        // Random squares with about a quarter of the board occupied, as in a middlegame
+        std::mt19937_64 rng(BENCH_SEED);
+        std::vector<BenchSample> samples(BENCH_SAMPLES);
+        for (BenchSample& sample : samples) {
+            sample.occupied = rng() & rng();
+            sample.square = static_cast<int>(rng() & 63);
+        }
+
+        int iterations = std::max(1, lookups / 2); // Two lookups per sample
+        auto start = std::chrono::steady_clock::now();
+
+        uint64_t checksum = 0ULL;
+        switch (slider_backend) {
+#ifdef SLIDERS_HAS_PEXT
+        case SLIDER_PEXT: checksum = runPextLookups(samples, iterations); break;
+#endif
+        case SLIDER_HYPERBOLA: checksum = runLookups<bishopAttacksHyperbola, rookAttacksHyperbola>(samples, iterations); break;
+        default: checksum = runLookups<bishopAttacksMagic, rookAttacksMagic>(samples, iterations); break;
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        bench_checksum = checksum;
+
+        setBackend(previous);
+        return seconds > 0.0 ? (2.0 * iterations) / seconds : 0.0;
+    }
+}
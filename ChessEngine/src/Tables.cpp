@@ -1,29 +1,37 @@
 #include "pch.h"
 #include "Tables.hpp"
 #include "Utils.hpp"
+#include "Scoring.hpp"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <cstdio>
 
 namespace Tables {
-	// Declare tables
-	uint64_t BETWEEN[64][64];
-	uint64_t LINE[64][64];
-	Direction DIR[64][64];
+	int8_t LMR_REDUCTIONS[MAX_DEPTH][MAX_MOVES];
 
-	uint16_t KILLER_MOVES[MAX_DEPTH][2] = { NULL_MOVE };
-	int* HISTORY_TABLE = new int[MAX_HISTORY_KEY](); // Zero-initialized array
-
-	TTEntry* TRANSPOSITION_TABLE = nullptr;
-	size_t TT_NUM_ENTRIES = 0;
+	TTCluster* TRANSPOSITION_TABLE = nullptr;
+	size_t TT_NUM_CLUSTERS = 0;
 	size_t TT_MASK = 0;
-
-	uint64_t PIECE_KEYS[2][6][64];
-	uint64_t SIDE_TO_MOVE_KEY;
-	uint64_t CASTLING_KEYS[16];
-	uint64_t EN_PASSANT_KEYS[8];
+	uint8_t TT_GENERATION = 0;
+	size_t TT_SIZE_MB = DESIRED_TT_SIZE_MB;
 
 	std::atomic<bool> initialized{ false }; // Atomic for thread safety
 
+	/*************************
+	Compile-time tables
+	*************************/
+
 	// Compute direction between squares
-	Direction getDirection(int sq1, int sq2) {
+	constexpr Direction getDirection(int sq1, int sq2) {
 		int dx = Utils::getFile(sq2) - Utils::getFile(sq1);
 		int dy = Utils::getRank(sq2) - Utils::getRank(sq1);
 
@@ -43,7 +51,7 @@ namespace Tables {
 	}
 
 	// Compute squares between two squares (exclusive)
-	uint64_t computeBetween(int sq1, int sq2) {
+	constexpr uint64_t computeBetween(int sq1, int sq2) {
 		Direction d = getDirection(sq1, sq2);
 		if (d == NONE) return 0ULL;
 
@@ -66,16 +74,15 @@ namespace Tables {
 	}
 
 	// Compute entire line through two squares (inclusive)
-	uint64_t computeLine(int sq1, int sq2) {
+	constexpr uint64_t computeLine(int sq1, int sq2) {
 		Direction d = getDirection(sq1, sq2);
 		if (d == NONE) return 1ULL << sq1;  // Single square
 
 		uint64_t result = 0ULL;
 
-		// Scan in both directions from sq1
+		// Scan in both directions from sq1 up to the board edges
 		for (int current = sq1; current >= 0 && current < 64; current += d) {
 			result |= (1ULL << current);
-			if (current == sq2) break;
 			if ((d == EAST && Utils::getFile(current) == 7) ||
 				(d == WEST && Utils::getFile(current) == 0) ||
 				(d == NORTH_EAST && Utils::getFile(current) == 7) ||
@@ -86,7 +93,6 @@ namespace Tables {
 
 		for (int current = sq1; current >= 0 && current < 64; current -= d) {
 			result |= (1ULL << current);
-			if (current == sq2) break;
 			if ((d == EAST && Utils::getFile(current) == 0) ||
 				(d == WEST && Utils::getFile(current) == 7) ||
 				(d == NORTH_EAST && Utils::getFile(current) == 0) ||
@@ -98,105 +104,496 @@ namespace Tables {
 		return result;
 	}
 
-	void initZobristKeys() {
-		// Random number generator
-		std::mt19937_64 rng(123456789);
-		std::uniform_int_distribution<uint64_t> dist;
+	template <typename T>
+	constexpr SquareTable<T> buildSquareTable(T (*compute)(int, int)) {
+		SquareTable<T> table{};
+		for (int sq1 = 0; sq1 < 64; sq1++) {
+			for (int sq2 = 0; sq2 < 64; sq2++) {
+				table[sq1][sq2] = compute(sq1, sq2);
+			}
+		}
+		return table;
+	}
+
+	constinit const SquareTable<uint64_t> BETWEEN = buildSquareTable(computeBetween);
+	constinit const SquareTable<uint64_t> LINE = buildSquareTable(computeLine);
+	constinit const SquareTable<Direction> DIR = buildSquareTable(getDirection);
+
+	// SplitMix64, a constexpr generator so the keys are fixed at compile time
+	// Every output of the sequence is distinct, no two keys can collide
+	struct ZobristRandom {
+		uint64_t state;
+
+		constexpr uint64_t next() {
+			uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			return z ^ (z >> 31);
+		}
+	};
+
+	struct ZobristKeys {
+		std::array<std::array<std::array<uint64_t, 64>, 6>, 2> piece;
+		std::array<uint64_t, 16> castling;
+		std::array<uint64_t, 8> en_passant;
+		uint64_t side_to_move;
+	};
+
+	constexpr ZobristKeys buildZobristKeys() {
+		ZobristRandom rng{ ZOBRIST_SEED };
+		ZobristKeys keys{};
 
 		// Init piece keys
 		for (int color = BLACK; color <= WHITE; ++color) { // 0 = Black, 1 = White
 			for (int piece = PAWN; piece <= KING; ++piece) {
 				for (int square = 0; square < 64; ++square) {
-					PIECE_KEYS[color][piece][square] = dist(rng);
+					keys.piece[color][piece][square] = rng.next();
 				}
 			}
 		}
 
 		// Init castling keys (one per bitmask value)
 		for (int i = 0; i < 16; i++) {
-			CASTLING_KEYS[i] = dist(rng);
+			keys.castling[i] = rng.next();
 		}
 
 		// Init en passant keys (one per file)
 		for (int i = 0; i < 8; i++) {
-			EN_PASSANT_KEYS[i] = dist(rng);
+			keys.en_passant[i] = rng.next();
 		}
 
 		// Side to move key
-		SIDE_TO_MOVE_KEY = dist(rng);
+		keys.side_to_move = rng.next();
+		return keys;
+	}
+
+	constexpr ZobristKeys ZOBRIST = buildZobristKeys();
+
+	constinit const std::array<std::array<std::array<uint64_t, 64>, 6>, 2> PIECE_KEYS = ZOBRIST.piece;
+	constinit const uint64_t SIDE_TO_MOVE_KEY = ZOBRIST.side_to_move;
+	constinit const std::array<uint64_t, 16> CASTLING_KEYS = ZOBRIST.castling;
+	constinit const std::array<uint64_t, 8> EN_PASSANT_KEYS = ZOBRIST.en_passant;
+
+	// Can the piece move between the squares on an empty board
+	constexpr bool reachesOnEmptyBoard(PieceType piece, int sq1, int sq2) {
+		int dx = Utils::getFile(sq2) - Utils::getFile(sq1);
+		int dy = Utils::getRank(sq2) - Utils::getRank(sq1);
+		dx = dx < 0 ? -dx : dx;
+		dy = dy < 0 ? -dy : dy;
+		Direction d = getDirection(sq1, sq2);
+
+		switch (piece) {
+		case KNIGHT: return (dx == 1 && dy == 2) || (dx == 2 && dy == 1);
+		case BISHOP: return dx == dy && d != NONE;
+		case ROOK:   return (dx == 0 || dy == 0) && d != NONE;
+		case QUEEN:  return d != NONE;
+		case KING:   return std::max(dx, dy) == 1;
+		default:     return false;
+		}
+	}
+
+	struct CuckooTables {
+		std::array<uint64_t, CUCKOO_SIZE> keys;
+		std::array<uint16_t, CUCKOO_SIZE> moves;
+	};
+
+	// Fill the cuckoo table with every reversible piece move
+	constexpr CuckooTables buildCuckooTables() {
+		CuckooTables cuckoo{};
+		for (uint16_t& move : cuckoo.moves) move = NULL_MOVE;
+
+		int count = 0;
+		for (int color = BLACK; color <= WHITE; ++color) {
+			for (int piece = KNIGHT; piece <= KING; ++piece) {
+				for (int sq1 = 0; sq1 < 64; ++sq1) {
+					for (int sq2 = sq1 + 1; sq2 < 64; ++sq2) {
+						if (!reachesOnEmptyBoard(static_cast<PieceType>(piece), sq1, sq2)) continue;
+
+						uint64_t key = ZOBRIST.piece[color][piece][sq1] ^ ZOBRIST.piece[color][piece][sq2] ^ ZOBRIST.side_to_move;
+						uint16_t move = static_cast<uint16_t>(sq1 | (sq2 << 6));
+
+						// Insert, kicking the occupant to its other slot until an empty slot is found
+						int slot = cuckooSlot1(key);
+						while (true) {
+							std::swap(cuckoo.keys[slot], key);
+							std::swap(cuckoo.moves[slot], move);
+							if (move == NULL_MOVE) break;
+							slot = (slot == cuckooSlot1(key)) ? cuckooSlot2(key) : cuckooSlot1(key);
+						}
+						count++;
+					}
+				}
+			}
+		}
+		assert(count == 3668);
+		return cuckoo;
+	}
+
+	constexpr CuckooTables CUCKOO = buildCuckooTables();
+
+	constinit const std::array<uint64_t, CUCKOO_SIZE> CUCKOO_KEYS = CUCKOO.keys;
+	constinit const std::array<uint16_t, CUCKOO_SIZE> CUCKOO_MOVES = CUCKOO.moves;
+
+	/*************************
+	Transposition table
+	*************************/
+
+	// Allocate zeroed memory for the table straight from the OS
+	// Linux backs the table with transparent huge pages when possible, fewer TLB misses on random probes
+	// Returns nullptr on failure
+	void* allocateTable(size_t bytes) {
+#if defined(_WIN32)
+		return VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#elif defined(__linux__)
+		void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (memory == MAP_FAILED) return nullptr;
+#ifdef MADV_HUGEPAGE
+		madvise(memory, bytes, MADV_HUGEPAGE);
+#endif
+		return memory;
+#else
+		void* memory = ::operator new(bytes, std::align_val_t(alignof(TTCluster)), std::nothrow);
+		if (memory) std::memset(memory, 0, bytes);
+		return memory;
+#endif
+	}
+
+	void freeTable(void* memory, size_t bytes) {
+		if (!memory) return;
+#if defined(_WIN32)
+		VirtualFree(memory, 0, MEM_RELEASE);
+#elif defined(__linux__)
+		munmap(memory, bytes);
+#else
+		::operator delete(memory, std::align_val_t(alignof(TTCluster)));
+#endif
 	}
 
 	// --- Function to initialize the Transposition Table ---
 	void initializeTT(size_t size_in_mb) {
-		// Calculate total bytes and number of raw entries
+		// Calculate total bytes and number of raw clusters
 		size_t total_bytes = size_in_mb * 1024 * 1024;
-		size_t entry_size = sizeof(TTEntry);
-		size_t num_entries_raw = total_bytes / entry_size;
+		size_t num_clusters_raw = total_bytes / sizeof(TTCluster);
 
 		// Round down to the nearest power of 2
-		// Simple bit manipulation trick: find highest set bit, create mask
-		TT_NUM_ENTRIES = 1;
-		while (TT_NUM_ENTRIES * 2 <= num_entries_raw) {
-			TT_NUM_ENTRIES *= 2;
+		TT_NUM_CLUSTERS = 1;
+		while (TT_NUM_CLUSTERS * 2 <= num_clusters_raw) {
+			TT_NUM_CLUSTERS *= 2;
 		}
 
-		TT_MASK = TT_NUM_ENTRIES - 1; // Mask for indexing (works because size is power of 2)
+		TT_GENERATION = 0;
 
-		// --- Allocate the memory using new[] ---
-		TRANSPOSITION_TABLE = new TTEntry[TT_NUM_ENTRIES];
+		// Fresh pages from the OS are already zero, all-zero entries have FLAG_NONE which marks them empty
+		// No clearing pass on the startup path
+		TRANSPOSITION_TABLE = static_cast<TTCluster*>(allocateTable(TT_NUM_CLUSTERS * sizeof(TTCluster)));
+		if (!TRANSPOSITION_TABLE) {
+			TT_NUM_CLUSTERS = 0; // Search runs without a table, probes miss and stores are dropped
+		}
 
-		// --- Clear the allocated memory ---
-		// This ensures all entries start in a known state (e.g., depth=-1, flag=FLAG_NONE)
-		// We rely on the TTEntry default member initializers or clear manually.
-		// Using memset is fast if all-zero bytes represent the desired initial "empty" state.
-		// Here, our default initializers mostly handle it, but let's explicitly clear
-		// to ensure depth is -1 and flag is FLAG_NONE if defaults weren't used.
-		std::memset(TRANSPOSITION_TABLE, 0, TT_NUM_ENTRIES * sizeof(TTEntry));
+		TT_MASK = TT_NUM_CLUSTERS - 1; // Mask for indexing (works because size is power of 2)
 	}
 
-	void initTables() {
-		bool expected = false;
-		if (!initialized.compare_exchange_strong(expected, true)) {
-			return; // Already initialized
+	void resizeTT(size_t size_in_mb) {
+		TT_SIZE_MB = std::clamp(size_in_mb, MIN_TT_SIZE_MB, MAX_TT_SIZE_MB);
+		if (!initialized.load()) return; // Allocated by initTables
+
+		freeTable(TRANSPOSITION_TABLE, TT_NUM_CLUSTERS * sizeof(TTCluster));
+		TRANSPOSITION_TABLE = nullptr;
+		initializeTT(TT_SIZE_MB);
+	}
+
+	void clearTT() {
+		if (TT_NUM_CLUSTERS == 0) return;
+
+		// Split the table into one contiguous slice per thread
+		size_t bytes = TT_NUM_CLUSTERS * sizeof(TTCluster);
+		size_t thread_count = std::clamp<size_t>(bytes / TT_CLEAR_BYTES_PER_THREAD, 1, std::max(1u, std::thread::hardware_concurrency()));
+		size_t slice = TT_NUM_CLUSTERS / thread_count;
+
+		// Cleared as raw memory, all zero bits is an empty entry
+		std::vector<std::thread> workers;
+		for (size_t i = 1; i < thread_count; i++) {
+			size_t begin = i * slice;
+			size_t count = (i == thread_count - 1) ? TT_NUM_CLUSTERS - begin : slice;
+			workers.emplace_back([begin, count] {
+				std::memset(static_cast<void*>(TRANSPOSITION_TABLE + begin), 0, count * sizeof(TTCluster));
+			});
 		}
+		std::memset(static_cast<void*>(TRANSPOSITION_TABLE), 0, (thread_count == 1 ? TT_NUM_CLUSTERS : slice) * sizeof(TTCluster));
+		for (std::thread& worker : workers) worker.join();
+
+		TT_GENERATION = 0;
+	}
+
+	int hashfullTT() {
+		if (TT_NUM_CLUSTERS == 0) return 0;
 
-		// Reallocate if needed
-		// TT is reallocated in it's init function
-		if (HISTORY_TABLE == nullptr) {
-			HISTORY_TABLE = new int[MAX_HISTORY_KEY]();
+		size_t clusters = std::min<size_t>(TT_HASHFULL_SAMPLE, TT_NUM_CLUSTERS);
+		size_t used = 0;
+		for (size_t i = 0; i < clusters; i++) {
+			for (const TTEntry& entry : TRANSPOSITION_TABLE[i].entries) {
+				if (entry.flag() != FLAG_NONE && entry.generation() == TT_GENERATION) used++;
+			}
 		}
+		return static_cast<int>(used * 1000 / (clusters * TT_CLUSTER_SIZE));
+	}
 
-		// Zero initialize killer moves explicitly
-		std::memset(KILLER_MOVES, 0, sizeof(KILLER_MOVES));
+	// Mate scores don't fit 16 bits, move them next to the ends of the int16 range
+	// Normal scores are clamped below the mate band
+	// Mates are scored by search ply, every search ply has to fit the band
+	static_assert(MAX_SEARCH_DEPTH <= MAX_PLY_FROM_MATE, "Mate band must cover the search depth");
 
-		// Initialize geometric tables
-		for (int sq1 = 0; sq1 < 64; sq1++) {
-			for (int sq2 = 0; sq2 < 64; sq2++) {
-				DIR[sq1][sq2] = getDirection(sq1, sq2);
-				BETWEEN[sq1][sq2] = uint64_t(computeBetween(sq1, sq2));
-				LINE[sq1][sq2] = uint64_t(computeLine(sq1, sq2));
+	int16_t packScore(int score) {
+		assert(std::abs(score) <= MATE_SCORE);
+		if (score > MATE_SCORE - MAX_PLY_FROM_MATE) return static_cast<int16_t>(INT16_MAX - (MATE_SCORE - score));
+		if (score < -MATE_SCORE + MAX_PLY_FROM_MATE) return static_cast<int16_t>(-INT16_MAX + (MATE_SCORE + score));
+		return static_cast<int16_t>(std::clamp(score, -INT16_MAX + MAX_PLY_FROM_MATE, INT16_MAX - MAX_PLY_FROM_MATE));
+	}
+
+	int unpackScore(int16_t score) {
+		if (score > INT16_MAX - MAX_PLY_FROM_MATE) return MATE_SCORE - (INT16_MAX - score);
+		if (score < -INT16_MAX + MAX_PLY_FROM_MATE) return -MATE_SCORE + (INT16_MAX + score);
+		return score;
+	}
+
+	// Searches since the entry was last written or probed
+	int relativeAge(const TTEntry& entry) {
+		return ((TT_GENERATION_CYCLE + TT_GENERATION - entry.gen_flag) & TT_GENERATION_MASK) / TT_GENERATION_DELTA;
+	}
+
+	bool probeTT(uint64_t key, TTData& data) {
+		if (TT_NUM_CLUSTERS == 0) return false;
+
+		TTCluster& cluster = TRANSPOSITION_TABLE[key & TT_MASK];
+		uint16_t key16 = static_cast<uint16_t>(key >> 48);
+
+		for (TTEntry& slot : cluster.entries) {
+			// Work on a copy, another thread may overwrite the slot while we read it
+			TTEntry entry = slot;
+			if (entry.key16 != key16 || entry.flag() == FLAG_NONE) continue;
+
+			// Still in use, keep it from aging out
+			slot.gen_flag = static_cast<uint8_t>(TT_GENERATION | entry.flag());
+
+			data.best_move = entry.best_move;
+			data.score = unpackScore(entry.score);
+			data.static_eval = entry.static_eval;
+			data.depth = entry.depth;
+			data.flag = entry.flag();
+			return true;
+		}
+		return false;
+	}
+
+	void storeTT(uint64_t key, uint16_t best_move, int score, int static_eval, int depth, TTFlag flag) {
+		if (TT_NUM_CLUSTERS == 0) return;
+
+		TTCluster& cluster = TRANSPOSITION_TABLE[key & TT_MASK];
+		uint16_t key16 = static_cast<uint16_t>(key >> 48);
+
+		// Entry of the same position if the cluster holds it
+		TTEntry* replace = nullptr;
+		for (TTEntry& slot : cluster.entries) {
+			if (slot.key16 == key16 && slot.flag() != FLAG_NONE) {
+				replace = &slot;
+				break;
 			}
 		}
 
-		// Init zobrist keys
-		initZobristKeys();
+		if (replace) {
+			TTEntry old = *replace;
+
+			// Keep deeper results of this search, and exact scores over bounds of the same depth
+			if (old.generation() == TT_GENERATION) {
+				if (old.depth > depth) return;
+				if (old.depth == depth && old.flag() == FLAG_EXACT && flag != FLAG_EXACT) return;
+			}
+
+			// A fail-low has no best move, keep the one we already know
+			if (best_move == NULL_MOVE) best_move = old.best_move;
+			if (static_eval == TT_NO_EVAL) static_eval = old.static_eval;
+		}
+		else {
+			// Take an empty entry, or the one with the least depth left after aging
+			replace = &cluster.entries[0];
+			for (TTEntry& slot : cluster.entries) {
+				if (slot.flag() == FLAG_NONE) {
+					replace = &slot;
+					break;
+				}
+				if (replace->depth - TT_AGE_WEIGHT * relativeAge(*replace) > slot.depth - TT_AGE_WEIGHT * relativeAge(slot)) {
+					replace = &slot;
+				}
+			}
+		}
 
-		// Init transposition table with desired size
-		initializeTT(DESIRED_TT_SIZE_MB);
+		TTEntry entry;
+		entry.best_move = best_move;
+		entry.key16 = key16;
+		entry.score = packScore(score);
+		entry.static_eval = static_cast<int16_t>(std::clamp(static_eval, TT_NO_EVAL, static_cast<int>(INT16_MAX)));
+		entry.depth = static_cast<int8_t>(depth);
+		entry.gen_flag = static_cast<uint8_t>(TT_GENERATION | flag);
+		*replace = entry;
+	}
+
+	// Header of a saved table, followed by the raw clusters
+	struct TTFileHeader {
+		char magic[8];            // TT_FILE_MAGIC
+		uint32_t version;         // TT_FILE_VERSION
+		uint32_t cluster_bytes;   // sizeof(TTCluster), guards against layout changes without a version bump
+		uint64_t zobrist_seed;    // ZOBRIST_SEED
+		uint64_t key_fingerprint; // XOR of all Zobrist keys, catches generators giving other keys for the same seed
+		uint64_t num_clusters;    // Power of 2
+		uint8_t generation;       // TT_GENERATION when saved, entry ages stay valid
+		uint8_t padding[7];
+	};
+	constexpr char TT_FILE_MAGIC[8] = { 'C', 'H', 'E', 'S', 'S', 'T', 'T', '\0' };
+
+	uint64_t zobristFingerprint() {
+		uint64_t fingerprint = SIDE_TO_MOVE_KEY;
+		for (int color = BLACK; color <= WHITE; ++color) {
+			for (int piece = PAWN; piece <= KING; ++piece) {
+				for (int square = 0; square < 64; ++square) {
+					fingerprint ^= PIECE_KEYS[color][piece][square];
+				}
+			}
+		}
+		for (uint64_t key : CASTLING_KEYS) fingerprint ^= key;
+		for (uint64_t key : EN_PASSANT_KEYS) fingerprint ^= key;
+		return fingerprint;
+	}
+
+	bool saveTT(const char* path) {
+		if (!path || TT_NUM_CLUSTERS == 0) return false;
+
+		TTFileHeader header = {};
+		std::memcpy(header.magic, TT_FILE_MAGIC, sizeof(header.magic));
+		header.version = TT_FILE_VERSION;
+		header.cluster_bytes = sizeof(TTCluster);
+		header.zobrist_seed = ZOBRIST_SEED;
+		header.key_fingerprint = zobristFingerprint();
+		header.num_clusters = TT_NUM_CLUSTERS;
+		header.generation = TT_GENERATION;
+
+		std::FILE* file = std::fopen(path, "wb");
+		if (!file) return false;
+		bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+			std::fwrite(TRANSPOSITION_TABLE, sizeof(TTCluster), TT_NUM_CLUSTERS, file) == TT_NUM_CLUSTERS;
+		return std::fclose(file) == 0 && written;
+	}
+
+	// Copy the table out of a mapped file after validating its header
+	bool loadMappedTT(const uint8_t* data, size_t size) {
+		TTFileHeader header;
+		if (size < sizeof(header)) return false;
+		std::memcpy(&header, data, sizeof(header));
+
+		if (std::memcmp(header.magic, TT_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+			header.version != TT_FILE_VERSION ||
+			header.cluster_bytes != sizeof(TTCluster) ||
+			header.zobrist_seed != ZOBRIST_SEED ||
+			header.key_fingerprint != zobristFingerprint()) return false;
+
+		// The size must be a power of 2 of at least a megabyte, and the file must hold all of it
+		size_t min_clusters = 1024 * 1024 / sizeof(TTCluster);
+		if (header.num_clusters < min_clusters || (header.num_clusters & (header.num_clusters - 1)) != 0 ||
+			header.num_clusters > MAX_TT_SIZE_MB * min_clusters ||
+			size - sizeof(header) < header.num_clusters * sizeof(TTCluster)) return false;
+
+		// Fill a new block before releasing the current table, a failed allocation leaves the table as it was
+		size_t bytes = header.num_clusters * sizeof(TTCluster);
+		TTCluster* table = static_cast<TTCluster*>(allocateTable(bytes));
+		if (!table) return false;
+		std::memcpy(static_cast<void*>(table), data + sizeof(header), bytes);
+
+		freeTable(TRANSPOSITION_TABLE, TT_NUM_CLUSTERS * sizeof(TTCluster));
+		TRANSPOSITION_TABLE = table;
+		TT_SIZE_MB = header.num_clusters / min_clusters;
+		TT_NUM_CLUSTERS = header.num_clusters;
+		TT_MASK = TT_NUM_CLUSTERS - 1;
+		TT_GENERATION = header.generation;
+		return true;
+	}
+
+	bool loadTT(const char* path) {
+		if (!path || !initialized.load()) return false;
+
+		bool loaded = false;
+#if defined(_WIN32)
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER size;
+		HANDLE mapping = GetFileSizeEx(file, &size) ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+		if (mapping) {
+			const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if (view) {
+				loaded = loadMappedTT(static_cast<const uint8_t*>(view), static_cast<size_t>(size.QuadPart));
+				UnmapViewOfFile(view);
+			}
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+#elif defined(__linux__)
+		int file = open(path, O_RDONLY);
+		if (file < 0) return false;
+		struct stat info;
+		if (fstat(file, &info) == 0 && info.st_size > 0) {
+			size_t size = static_cast<size_t>(info.st_size);
+			void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+			if (view != MAP_FAILED) {
+				madvise(view, size, MADV_SEQUENTIAL);
+				loaded = loadMappedTT(static_cast<const uint8_t*>(view), size);
+				munmap(view, size);
+			}
+		}
+		close(file);
+#else
+		// No file mapping, read the whole file instead
+		std::FILE* file = std::fopen(path, "rb");
+		if (!file) return false;
+		std::vector<uint8_t> data;
+		uint8_t buffer[1 << 16];
+		size_t read;
+		while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) data.insert(data.end(), buffer, buffer + read);
+		std::fclose(file);
+		loaded = loadMappedTT(data.data(), data.size());
+#endif
+
+		return loaded;
+	}
+
+	void newSearchTT() {
+		TT_GENERATION += TT_GENERATION_DELTA; // Wraps around, ages are computed modulo the cycle
+	}
+
+	void initTables() {
+		bool expected = false;
+		if (!initialized.compare_exchange_strong(expected, true)) {
+			return; // Already initialized
+		}
+
+		// Late move reductions, no reduction for the first move or a depth of zero
+		for (int depth = 0; depth < MAX_DEPTH; depth++) {
+			for (int index = 0; index < MAX_MOVES; index++) {
+				LMR_REDUCTIONS[depth][index] = (depth == 0 || index == 0) ? 0 :
+					static_cast<int8_t>(LMR_BASE + std::log(depth) * std::log(index) / LMR_DIVISOR);
+			}
+		}
+
+		// Init transposition table with the configured size
+		initializeTT(TT_SIZE_MB);
 	}
 
 	void teardownTables() {
 		if (!initialized.load()) return;
 
 		// Thread-safe cleanup
-		delete[] HISTORY_TABLE;
-		HISTORY_TABLE = nullptr;
-
-		delete[] TRANSPOSITION_TABLE;
+		freeTable(TRANSPOSITION_TABLE, TT_NUM_CLUSTERS * sizeof(TTCluster));
 		TRANSPOSITION_TABLE = nullptr;
 
 		// Reset sizes
-		TT_NUM_ENTRIES = 0;
+		TT_NUM_CLUSTERS = 0;
 		TT_MASK = 0;
 
 		// Must be last operation
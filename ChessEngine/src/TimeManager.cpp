@@ -0,0 +1,89 @@
+#include "pch.h"
+#include "TimeManager.hpp"
+
+TimeManager::TimeManager() :
+    soft_limit(0),
+    hard_limit(0),
+    timed(false),
+    previous_best_move(NULL_MOVE_32),
+    previous_score(0),
+    stable_iterations(0),
+    score_drop_scale(1.0f)
+{
+    start_time = std::chrono::steady_clock::now();
+}
+
+void TimeManager::start(const SearchLimits& limits) {
+    start_time = std::chrono::steady_clock::now();
+
+    previous_best_move = NULL_MOVE_32;
+    previous_score = 0;
+    stable_iterations = 0;
+    score_drop_scale = 1.0f;
+
+    // Hard per-move budget: spend it all, nothing to allocate
+    if (limits.move_time_ms > 0) {
+        timed = true;
+        hard_limit = std::max<int64_t>(1, limits.move_time_ms - MOVE_OVERHEAD_MS);
+        soft_limit = hard_limit;
+        return;
+    }
+
+    // No clock: depth-only search
+    if (limits.time_left_ms <= 0) {
+        timed = false;
+        soft_limit = hard_limit = 0;
+        return;
+    }
+
+    timed = true;
+
+    // Never plan for more than the remaining time minus the communication overhead
+    int64_t available = std::max<int64_t>(1, limits.time_left_ms - MOVE_OVERHEAD_MS);
+
+    // Split the remaining time evenly over the moves left, and spend most of the increment on this move
+    int moves_to_go = limits.moves_to_go > 0 ? std::min(limits.moves_to_go, MAX_MOVES_TO_GO) : DEFAULT_MOVES_TO_GO;
+    int64_t base = available / moves_to_go + (static_cast<int64_t>(limits.increment_ms) * 3) / 4;
+
+    soft_limit = std::min(base, available);
+    // The hard limit lets unstable positions overrun the plan, but never takes more than a fixed share of the clock
+    hard_limit = std::min(base * HARD_LIMIT_SCALE, static_cast<int64_t>(available * MAX_TIME_SHARE));
+    hard_limit = std::max(hard_limit, soft_limit);
+}
+
+int64_t TimeManager::elapsed() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+bool TimeManager::isTimed() const {
+    return timed;
+}
+
+bool TimeManager::hardLimitReached() const {
+    return timed && elapsed() >= hard_limit;
+}
+
+void TimeManager::updateIteration(uint32_t best_move, int score) {
+    // Count consecutive iterations agreeing on the best move
+    stable_iterations = (best_move == previous_best_move) ? stable_iterations + 1 : 0;
+
+    // Extend when the score drops compared to the previous iteration
+    // Keep the extension for one extra iteration so the search gets a chance to find the fix
+    int drop = previous_best_move == NULL_MOVE_32 ? 0 : previous_score - score;
+    if (drop >= 3 * SCORE_DROP_MARGIN) score_drop_scale = 2.0f;
+    else if (drop >= SCORE_DROP_MARGIN) score_drop_scale = 1.5f;
+    else score_drop_scale = std::max(1.0f, score_drop_scale - 0.25f);
+
+    previous_best_move = best_move;
+    previous_score = score;
+}
+
+bool TimeManager::softLimitReached() const {
+    if (!timed) return false;
+
+    // A stable best move gives up to half of the planned time back, a fresh one gets a bit more
+    float stability_scale = std::max(0.5f, 1.2f - 0.15f * stable_iterations);
+
+    int64_t limit = static_cast<int64_t>(soft_limit * stability_scale * score_drop_scale);
+    return elapsed() >= std::min(limit, hard_limit);
+}
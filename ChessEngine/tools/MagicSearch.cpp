@@ -0,0 +1,129 @@
+// MagicSearch.cpp: Offline search for denser magic numbers, not part of the engine DLL.
+//
+// For every square it looks for a magic with the wanted number of index bits (the relevant bits plus an offset,
+// negative for denser magics) and keeps the one whose highest used index is the lowest.
+// The magic table in Magic.cpp packs each slice up to its highest used index, so a lower span shrinks the shared table
+// even when the index bits stay the same. Squares without a magic in the given tries keep the current one.
+//
+// The output is pasted over MAGICS_* and INDEX_BITS_* in Magic.hpp.
+//
+// Build from the ChessEngine folder (Developer Command Prompt or GCC):
+//   cl /std:c++20 /O2 /EHsc /Iinclude tools\MagicSearch.cpp
+//   g++ -std=c++20 -O2 -Iinclude tools/MagicSearch.cpp -o MagicSearch
+//
+// Usage: MagicSearch <bishop|rook> [bits offset = 0] [tries per square = 1000000] [seed]
+
+#include "pch.h"
+#include "Magic.hpp"
+#include "Utils.hpp"
+#include <cstdio>
+
+namespace {
+    struct SquareMagic {
+        uint64_t magic;
+        int index_bits;
+        uint64_t span; // Highest used index + 1
+    };
+
+    // Sparse random numbers make far better magic candidates
+    uint64_t sparseRandom(std::mt19937_64& rng) {
+        return rng() & rng() & rng();
+    }
+
+    // Highest used index + 1 if the magic maps every occupancy without a destructive collision, 0 otherwise
+    // Occupancies with the same attacks may share an index
+    uint64_t tryMagic(uint64_t magic, int index_bits, const std::vector<uint64_t>& occupancies,
+        const std::vector<uint64_t>& attacks, std::vector<uint64_t>& used, std::vector<uint32_t>& epochs, uint32_t epoch) {
+        uint64_t highest = 0ULL;
+        for (size_t i = 0; i < occupancies.size(); i++) {
+            uint64_t index = (occupancies[i] * magic) >> (64 - index_bits);
+            if (epochs[index] != epoch) {
+                epochs[index] = epoch;
+                used[index] = attacks[i];
+            }
+            else if (used[index] != attacks[i]) {
+                return 0ULL;
+            }
+            highest = std::max(highest, index);
+        }
+        return highest + 1;
+    }
+
+    SquareMagic searchSquare(int sq, bool bishop, int bits_offset, int tries, std::mt19937_64& rng) {
+        uint64_t mask = bishop ? Magic::maskBishopAttackRays(sq) : Magic::maskRookAttackRays(sq);
+        int relevant_bits = bishop ? Magic::RELEVANT_BITS_COUNT_BISHOP[sq] : Magic::RELEVANT_BITS_COUNT_ROOK[sq];
+
+        std::vector<uint64_t> occupancies(size_t(1) << relevant_bits);
+        std::vector<uint64_t> attacks(occupancies.size());
+        for (int i = 0; i < static_cast<int>(occupancies.size()); i++) {
+            occupancies[i] = Utils::setOccupancy(i, relevant_bits, mask);
+            attacks[i] = bishop ? Magic::maskBishopXrayAttacks(sq, occupancies[i]) : Magic::maskRookXrayAttacks(sq, occupancies[i]);
+        }
+
+        // Start from the magic in use so the result is never worse
+        SquareMagic best;
+        best.magic = bishop ? Magic::MAGICS_BISHOP[sq] : Magic::MAGICS_ROOK[sq];
+        best.index_bits = bishop ? Magic::INDEX_BITS_BISHOP[sq] : Magic::INDEX_BITS_ROOK[sq];
+
+        std::vector<uint64_t> used(occupancies.size() << 1);
+        std::vector<uint32_t> epochs(used.size(), 0);
+        uint32_t epoch = 1;
+        best.span = tryMagic(best.magic, best.index_bits, occupancies, attacks, used, epochs, epoch++);
+
+        int index_bits = std::clamp(relevant_bits + bits_offset, 1, relevant_bits);
+        for (int attempt = 0; attempt < tries; attempt++) {
+            uint64_t magic = sparseRandom(rng);
+
+            // Too few high bits never spread the occupancies over the index
+            if (Utils::countSetBits((mask * magic) & 0xFF00000000000000ULL) < 6) continue;
+
+            uint64_t span = tryMagic(magic, index_bits, occupancies, attacks, used, epochs, epoch++);
+            if (span != 0 && span < best.span) {
+                best = { magic, index_bits, span };
+            }
+        }
+        return best;
+    }
+
+    void printTable(const char* name, const SquareMagic magics[64], bool print_magics) {
+        std::printf("    constexpr %s %s[64] = {\n", print_magics ? "uint64_t" : "int", name);
+        for (int sq = 0; sq < 64; sq++) {
+            if (print_magics) std::printf("          0x%llxULL%s\n", static_cast<unsigned long long>(magics[sq].magic), sq < 63 ? "," : "");
+            else std::printf("%s%2d,%s", sq % 8 == 0 ? "        " : " ", magics[sq].index_bits, sq % 8 == 7 ? "\n" : "");
+        }
+        std::printf("    };\n\n");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || (std::strcmp(argv[1], "bishop") != 0 && std::strcmp(argv[1], "rook") != 0)) {
+        std::printf("Usage: MagicSearch <bishop|rook> [bits offset = 0] [tries per square = 1000000] [seed]\n");
+        return 1;
+    }
+
+    bool bishop = std::strcmp(argv[1], "bishop") == 0;
+    int bits_offset = argc > 2 ? std::atoi(argv[2]) : 0;
+    int tries = argc > 3 ? std::atoi(argv[3]) : 1000000;
+    std::mt19937_64 rng(argc > 4 ? std::strtoull(argv[4], nullptr, 0) : std::random_device{}());
+
+    SquareMagic magics[64];
+    uint64_t current_entries = 0ULL;
+    uint64_t found_entries = 0ULL;
+    for (int sq = 0; sq < 64; sq++) {
+        magics[sq] = searchSquare(sq, bishop, bits_offset, tries, rng);
+
+        int current_bits = bishop ? Magic::INDEX_BITS_BISHOP[sq] : Magic::INDEX_BITS_ROOK[sq];
+        current_entries += 1ULL << current_bits;
+        found_entries += magics[sq].span;
+        std::fprintf(stderr, "square %2d: %2d bits, span %5llu (was %5llu)\n", sq, magics[sq].index_bits,
+            static_cast<unsigned long long>(magics[sq].span), 1ULL << current_bits);
+    }
+
+    std::fprintf(stderr, "packed %s slices: %llu entries (%llu bytes), full ranges %llu entries (%llu bytes)\n", argv[1],
+        static_cast<unsigned long long>(found_entries), static_cast<unsigned long long>(found_entries * 8),
+        static_cast<unsigned long long>(current_entries), static_cast<unsigned long long>(current_entries * 8));
+
+    printTable(bishop ? "MAGICS_BISHOP" : "MAGICS_ROOK", magics, true);
+    printTable(bishop ? "INDEX_BITS_BISHOP" : "INDEX_BITS_ROOK", magics, false);
+    return 0;
+}
@@ -12,6 +12,9 @@ namespace Chess
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern IntPtr CreateBoard();
 
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr CloneBoard(IntPtr board);
+
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern void DestroyBoard(IntPtr board);
 
@@ -24,6 +27,45 @@ namespace Chess
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern void MakeBestMove(IntPtr board, int depth, bool white);
 
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void MakeBestMoveTimed(IntPtr board, int timeLeftMs, int incrementMs, int movesToGo, int moveTimeMs, bool white);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetThreads(int threads);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetCopyMake(bool enabled);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool SetSliderBackend(int backend);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetSliderBackend();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern double BenchSliderBackend(int backend, int lookups);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetHashSize(int sizeMb);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void ClearHash();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetHashfull();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool SaveHash(string path);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool LoadHash(string path);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void GetSearchStats(out ulong nodes, out ulong zeroWindowSearches, out ulong researches, out int depth, out long timeMs);
+
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         private static extern void GetBoardJSON(IntPtr board, IntPtr output, int size);
 